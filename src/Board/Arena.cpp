@@ -0,0 +1,64 @@
+#include "Arena.hpp"
+#include <cstdlib>
+
+static const size_t LARGE_BLOCK = ~(size_t)0;
+
+Arena::Arena(size_t chunkSize) {
+  this->chunkSize = chunkSize;
+  this->cursor = nullptr;
+  this->limit = nullptr;
+  this->current = 0;
+  this->live = 0;
+  for (size_t i = 0;i < CLASS_COUNT;i++)this->freeList[i] = nullptr;
+}
+Arena::~Arena() {
+  for (char* chunk : this->chunks)::operator delete(chunk);
+}
+void* Arena::Allocate(size_t size) {
+  size_t cls = (size + GRANULE - 1) / GRANULE;
+  this->live++;
+  if (cls == 0)cls = 1;
+  if (cls > CLASS_COUNT) {
+    char* block = static_cast<char*>(::operator new(size + HEADER));
+    *reinterpret_cast<size_t*>(block) = LARGE_BLOCK;
+    return block + HEADER;
+  }
+  // Reuse a freed block of the same class before carving a new one
+  if (this->freeList[cls - 1]) {
+    void* block = this->freeList[cls - 1];
+    this->freeList[cls - 1] = *static_cast<void**>(block);
+    return block;
+  }
+  size_t bytes = cls * GRANULE + HEADER;
+  if ((size_t)(this->limit - this->cursor) < bytes) {
+    // Move on to the next chunk, chunks left over from before a Reset are used before allocating new ones
+    if (this->cursor != nullptr)this->current++;
+    if (this->current == this->chunks.size())this->chunks.push_back(static_cast<char*>(::operator new(this->chunkSize)));
+    this->cursor = this->chunks[this->current];
+    this->limit = this->cursor + this->chunkSize;
+  }
+  char* block = this->cursor;
+  this->cursor += bytes;
+  *reinterpret_cast<size_t*>(block) = cls;
+  return block + HEADER;
+}
+void Arena::Free(void* ptr) {
+  if (ptr == nullptr)return;
+  this->live--;
+  char* block = static_cast<char*>(ptr) - HEADER;
+  size_t cls = *reinterpret_cast<size_t*>(block);
+  if (cls == LARGE_BLOCK) {
+    ::operator delete(block);
+    return;
+  }
+  *static_cast<void**>(ptr) = this->freeList[cls - 1];
+  this->freeList[cls - 1] = ptr;
+}
+void Arena::Reset() {
+  // Forget every block at once, the chunks stay around for the next board
+  for (size_t i = 0;i < CLASS_COUNT;i++)this->freeList[i] = nullptr;
+  this->current = 0;
+  this->cursor = this->chunks.empty() ? nullptr : this->chunks[0];
+  this->limit = this->chunks.empty() ? nullptr : this->chunks[0] + this->chunkSize;
+  this->live = 0;
+}
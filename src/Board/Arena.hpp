@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Board-owned memory for components, their pins and fan-out lists.
+// Small blocks are carved out of large chunks and recycled through per size free lists,
+// Reset hands every chunk back at once when the whole board goes away.
+class Arena {
+public:
+  static const size_t HEADER = 16;      // Size class stored in front of every allocation, keeps 16 byte alignment
+  static const size_t GRANULE = 16;
+  static const size_t CLASS_COUNT = 64; // Blocks up to 1 KiB are pooled, bigger ones go to the heap
+  std::vector<char*> chunks;
+  size_t chunkSize;
+  size_t current; // Chunk the cursor points into
+  char* cursor;
+  char* limit;
+  void* freeList[CLASS_COUNT];
+  size_t live; // Blocks currently handed out
+  Arena(size_t chunkSize = 64 * 1024);
+  ~Arena();
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  void* Allocate(size_t size);
+  void Free(void* ptr);
+  void Reset();
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(alignof(T) <= HEADER, "Arena blocks are only 16 byte aligned");
+    return new (this->Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+  }
+  template <typename T>
+  void Delete(T* ptr) {
+    if (ptr == nullptr)return;
+    ptr->~T();
+    this->Free(ptr);
+  }
+};
+
+// Lets the standard containers draw their storage from an Arena
+template <typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+  Arena* arena;
+  ArenaAllocator(Arena* arena) {
+    this->arena = arena;
+  }
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) {
+    this->arena = other.arena;
+  }
+  T* allocate(size_t n) {
+    return static_cast<T*>(this->arena->Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t) {
+    this->arena->Free(ptr);
+  }
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return this->arena == other.arena;
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return this->arena != other.arena;
+  }
+};
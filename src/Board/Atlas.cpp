@@ -0,0 +1,76 @@
+#include "Atlas.hpp"
+#include <rlgl.h>
+#include <algorithm>
+
+static const int ATLAS_WIDTH = 512;
+static const int ATLAS_PADDING = 2; // Keeps filtering from bleeding neighbouring images into each other
+
+void DrawSprite(const Sprite& sprite, Vector2 position, Color tint) {
+  DrawTextureRec(sprite.texture, sprite.source, position, tint);
+}
+
+TextureAtlas::TextureAtlas() {
+  this->texture = { 0 };
+  this->white = { 0,0,0,0 };
+}
+void TextureAtlas::Add(std::string name, const char* fileName) {
+  this->names.push_back(name);
+  this->images.push_back(LoadImage(fileName));
+}
+void TextureAtlas::Build() {
+  // Shelf packing, tallest images first so every shelf wastes little height
+  std::vector<int> order(this->images.size());
+  for (size_t i = 0;i < order.size();i++)order[i] = (int)i;
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return this->images[a].height > this->images[b].height; });
+  std::vector<Rectangle> placed(this->images.size());
+  int x = ATLAS_PADDING, y = ATLAS_PADDING, shelf = 0, width = ATLAS_WIDTH;
+  for (int i : order) {
+    if (this->images[i].width + 2 * ATLAS_PADDING > width)width = this->images[i].width + 2 * ATLAS_PADDING;
+  }
+  for (int i : order) {
+    const Image& image = this->images[i];
+    if (x + image.width + ATLAS_PADDING > width) {
+      x = ATLAS_PADDING;
+      y += shelf + ATLAS_PADDING;
+      shelf = 0;
+    }
+    placed[i] = { (float)x,(float)y,(float)image.width,(float)image.height };
+    x += image.width + ATLAS_PADDING;
+    if (image.height > shelf)shelf = image.height;
+  }
+  // The white block goes on a shelf of its own below the images
+  int whiteY = y + shelf + ATLAS_PADDING;
+  int height = whiteY + 3 + ATLAS_PADDING;
+
+  Image atlas = GenImageColor(width, height, BLANK);
+  for (size_t i = 0;i < this->images.size();i++) {
+    const Image& image = this->images[i];
+    ImageDraw(&atlas, image, { 0,0,(float)image.width,(float)image.height }, placed[i], WHITE);
+  }
+  ImageDrawRectangle(&atlas, ATLAS_PADDING, whiteY, 3, 3, WHITE);
+  this->texture = LoadTextureFromImage(atlas);
+  UnloadImage(atlas);
+  for (size_t i = 0;i < this->images.size();i++) {
+    this->sprites[this->names[i]] = { this->texture,placed[i] };
+    UnloadImage(this->images[i]);
+  }
+  this->names.clear();
+  this->images.clear();
+  // Sample the middle of the 3x3 block so the edges never blend in
+  this->white = { (float)ATLAS_PADDING + 1,(float)whiteY + 1,1,1 };
+  SetShapesTexture(this->texture, this->white);
+}
+Sprite TextureAtlas::Get(const std::string& name) {
+  auto it = this->sprites.find(name);
+  if (it == this->sprites.end())return { this->texture,{ 0,0,0,0 } };
+  return it->second;
+}
+void TextureAtlas::Unload() {
+  if (this->texture.id == 0)return;
+  // Hand the shapes back their default texture before this one goes away
+  Texture2D texture = { rlGetTextureIdDefault(),1,1,1,PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+  SetShapesTexture(texture, { 0,0,1,1 });
+  UnloadTexture(this->texture);
+  this->texture = { 0 };
+  this->sprites.clear();
+}
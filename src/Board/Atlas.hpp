@@ -0,0 +1,29 @@
+#pragma once
+#include <raylib.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Region of a texture, every component graphic is a region of the one atlas texture
+typedef struct Sprite {
+  Texture2D texture;
+  Rectangle source;
+}Sprite;
+
+void DrawSprite(const Sprite& sprite, Vector2 position, Color tint);
+
+// All the component graphics packed into a single texture so the whole board draws in one batch.
+// A white texel is packed as well and handed to the shapes functions, pins and wires then share the texture too.
+class TextureAtlas {
+public:
+  Texture2D texture;
+  Rectangle white;
+  std::map<std::string, Sprite> sprites;
+  std::vector<std::string> names; // Images waiting for Build
+  std::vector<Image> images;
+  TextureAtlas();
+  void Add(std::string name, const char* fileName);
+  void Build();
+  Sprite Get(const std::string& name);
+  void Unload();
+};
@@ -1,16 +1,22 @@
 #include "Board.hpp"
 #include <raylib.h>
 #include <string>
-#include <iostream>
 #include <raymath.h>
 #include <chrono>   // For time-related functionalities (timestamps)
 #include <ctime>    // For std::time and std::gmtime/localtime
 #include <iomanip>  // For std::put_time to format time
 #include <algorithm>
 #include <raygui.h>
+#include <rlgl.h>
+#include <cmath>
 #include <typeinfo>
 #include <fstream>  // For File Operations
+#include <unordered_map>
 #include "../FileDialog/RecentProjects.hpp"
+#include "../Serializer/Serializer.hpp"
+#include "../Serializer/BinaryFormat.hpp"
+#include "../Serializer/MappedFile.hpp"
+#include "../Serializer/EditLog.hpp"
 
 
 enum class ManhattanBendStyle {
@@ -84,21 +90,6 @@ std::string generateUniqueId(const std::string& customString) {
   return customString + "_" + oss.str();
 }
 
-// Function to Split the given string into a list of strings based on some delimiter string
-std::vector<std::string> splitStringByDelimiter(const std::string& str, const std::string& delimiter) {
-  std::vector<std::string> tokens;
-  size_t start = 0;
-  size_t end = str.find(delimiter); // Find first occurrence of delimiter
-
-  while (end != std::string::npos) { // Loop while delimiter is found
-    tokens.push_back(str.substr(start, end - start)); // Extract substring
-    start = end + delimiter.length(); // Move start past the delimiter
-    end = str.find(delimiter, start); // Find next occurrence from new start
-  }
-  tokens.push_back(str.substr(start)); // Add the last token
-
-  return tokens;
-}
 // Function to get the File Name from the File Path
 std::string getFileName(const std::string& filePath) {
   // Determine the appropriate path separator
@@ -123,58 +114,160 @@ Board::Board(Rectangle dimension) {
   this->dimension = dimension;
   this->activeComponent = nullptr;
   this->simulationRunning = false;
+  this->simulationMode = SIM_LEVELIZED;
+  this->netlistDirty = true;
+  this->netlistPatched = false;
+  this->wiresDirty = true;
+  this->tickPeriod = SIM_SECOND / 60;
+  this->threadedSimulation = true;
+  this->simGeneration = 0;
   this->dropDown = new DropDown(this);
+  // World and screen coordinates match until the view is panned or zoomed, which keeps old save files in place
+  this->camera.offset = { dimension.x,dimension.y };
+  this->camera.target = { dimension.x,dimension.y };
+  this->camera.rotation = 0;
+  this->camera.zoom = 1;
+  this->lod.spriteZoom = 0.35f;
+  this->lod.wireZoom = 0.25f;
+
+  this->events.Register(EVENT_SELECT, [this](Component* comp, void*) {
+    this->activeComponent = comp;
+    });
+  this->events.Register(EVENT_INPUT_PIN, [this](Component*, void* pin) {
+    this->inputPin = (InputPin*)pin;
+    });
+  this->events.Register(EVENT_OUTPUT_PIN, [this](Component*, void* pin) {
+    this->outputPin = (OutputPin*)pin;
+    });
 
-  this->textures["and"] = LoadTexture("../asset/graphics/Gate_and.png");
-  this->textures["or"] = LoadTexture("../asset/graphics/Gate_or.png");
-  this->textures["not"] = LoadTexture("../asset/graphics/Gate_not.png");
-  this->textures["nor"] = LoadTexture("../asset/graphics/Gate_nor.png");
-  this->textures["nand"] = LoadTexture("../asset/graphics/Gate_nand.png");
-  this->textures["xor"] = LoadTexture("../asset/graphics/Gate_xor.png");
-  this->textures["switch_on"] = LoadTexture("../asset/graphics/Switch_on.png");
-  this->textures["switch_off"] = LoadTexture("../asset/graphics/Switch_off.png");
-  this->textures["bulb_on"] = LoadTexture("../asset/graphics/Bulb_on.png");
-  this->textures["bulb_off"] = LoadTexture("../asset/graphics/Bulb_off.png");
-  this->textures["clock_1"] = LoadTexture("../asset/graphics/clock_1.png");
-  this->textures["clock_5"] = LoadTexture("../asset/graphics/clock_5.png");
-  this->textures["clock_10"] = LoadTexture("../asset/graphics/clock_10.png");
-  this->textures["clock_30"] = LoadTexture("../asset/graphics/clock_30.png");
-  this->textures["clock_60"] = LoadTexture("../asset/graphics/clock_60.png");
-
+  this->atlas.Add("and", "../asset/graphics/Gate_and.png");
+  this->atlas.Add("or", "../asset/graphics/Gate_or.png");
+  this->atlas.Add("not", "../asset/graphics/Gate_not.png");
+  this->atlas.Add("nor", "../asset/graphics/Gate_nor.png");
+  this->atlas.Add("nand", "../asset/graphics/Gate_nand.png");
+  this->atlas.Add("xor", "../asset/graphics/Gate_xor.png");
+  this->atlas.Add("switch_on", "../asset/graphics/Switch_on.png");
+  this->atlas.Add("switch_off", "../asset/graphics/Switch_off.png");
+  this->atlas.Add("bulb_on", "../asset/graphics/Bulb_on.png");
+  this->atlas.Add("bulb_off", "../asset/graphics/Bulb_off.png");
+  this->atlas.Add("clock_1", "../asset/graphics/clock_1.png");
+  this->atlas.Add("clock_5", "../asset/graphics/clock_5.png");
+  this->atlas.Add("clock_10", "../asset/graphics/clock_10.png");
+  this->atlas.Add("clock_30", "../asset/graphics/clock_30.png");
+  this->atlas.Add("clock_60", "../asset/graphics/clock_60.png");
+  this->atlas.Build();
+
+  // Edits of a board that was never saved are journaled here, anything left over from a crash comes back
+  this->recording = true;
+  this->journalFile = AUTOSAVE_JOURNAL;
+  this->savedEdits = 0;
+  this->canAppend = false;
+  this->compressSaves = true;
+  this->lastAutosave = 0;
+  this->ReplayJournal(this->journalFile);
 }
 Board::~Board() {
-  UnloadTexture(this->textures["and"]);
-  UnloadTexture(this->textures["or"]);
-  UnloadTexture(this->textures["not"]);
-  UnloadTexture(this->textures["nor"]);
-  UnloadTexture(this->textures["nand"]);
-  UnloadTexture(this->textures["xor"]);
-  UnloadTexture(this->textures["switch_on"]);
-  UnloadTexture(this->textures["switch_off"]);
-  UnloadTexture(this->textures["bulb_on"]);
-  UnloadTexture(this->textures["bulb_off"]);
-  UnloadTexture(this->textures["clock_1"]);
-  UnloadTexture(this->textures["clock_5"]);
-  UnloadTexture(this->textures["clock_10"]);
-  UnloadTexture(this->textures["clock_30"]);
-  UnloadTexture(this->textures["clock_60"]);
-}
-void Board::DrawConnection(Component* comp) {
-  // Draw only the input Connections from every component
-  for (auto inPin : (*comp->inputs)) {
-    if (inPin.child) {
-      if (inPin.child->self->state)DrawLineManhattan(inPin.position, inPin.child->position, 2.0f, { 255,29,13,255 }, ManhattanBendStyle::BendAtMidpoint);
-      else DrawLineManhattan(inPin.position, inPin.child->position, 2.0f, { 110,168,74,255 }, ManhattanBendStyle::BendAtMidpoint);
+  this->simThread.Stop();
+  this->FlushJournal();
+  this->ClearBoard();
+  delete this->dropDown;
+  this->atlas.Unload();
+}
+// Cache the BendAtMidpoint route of a connection, it only changes when one of its ends moves
+static void RouteWire(InputPin& input) {
+  Vector2 start = input.position, end = input.child->position;
+  float midX = (start.x + end.x) / 2.0f;
+  input.wire[0] = start;
+  input.wire[1] = { midX, start.y };
+  input.wire[2] = { midX, end.y };
+  input.wire[3] = end;
+}
+// The route never leaves the box spanned by its two ends
+static Rectangle WireBounds(const InputPin& input) {
+  float minX = fminf(input.wire[0].x, input.wire[3].x), minY = fminf(input.wire[0].y, input.wire[3].y);
+  return { minX - 1,minY - 1,fabsf(input.wire[3].x - input.wire[0].x) + 2,fabsf(input.wire[3].y - input.wire[0].y) + 2 };
+}
+// Two triangles covering the segment, same corners and winding as DrawLineEx
+static void WriteWireSegment(Vector2* vertices, Vector2 start, Vector2 end, float thick) {
+  Vector2 delta = { end.x - start.x, end.y - start.y };
+  float length = sqrtf(delta.x * delta.x + delta.y * delta.y);
+  Vector2 radius = { 0,0 };
+  if (length > 0) {
+    float scale = thick / (2 * length);
+    radius = { -scale * delta.y, scale * delta.x };
+  }
+  Vector2 strip[4] = {
+    { start.x - radius.x, start.y - radius.y },
+    { start.x + radius.x, start.y + radius.y },
+    { end.x - radius.x, end.y - radius.y },
+    { end.x + radius.x, end.y + radius.y }
+  };
+  vertices[0] = strip[2];
+  vertices[1] = strip[0];
+  vertices[2] = strip[1];
+  vertices[3] = strip[3];
+  vertices[4] = strip[2];
+  vertices[5] = strip[1];
+}
+static void WriteWire(Vector2* vertices, const InputPin& input) {
+  for (int i = 0;i < 3;i++)WriteWireSegment(vertices + 6 * i, input.wire[i], input.wire[i + 1], 2.0f);
+}
+void Board::BuildWires() {
+  // Every connection becomes WIRE_VERTICES vertices, only the colour is decided when drawing
+  this->wireVertices.clear();
+  for (Component* comp : this->components) {
+    for (auto& inPin : (*comp->inputs)) {
+      if (!inPin.child)continue;
+      inPin.wireIndex = (int)(this->wireVertices.size() / WIRE_VERTICES);
+      this->wireVertices.resize(this->wireVertices.size() + WIRE_VERTICES);
+      WriteWire(this->wireVertices.data() + inPin.wireIndex * WIRE_VERTICES, inPin);
     }
   }
+  this->wiresDirty = false;
+}
+void Board::DrawWires(Rectangle area) {
+  if (this->wiresDirty)this->BuildWires();
+  this->wireGrid.QueryRect(area, this->visibleWires);
+  if (this->visibleWires.empty())return;
+  // All the visible wires go out in a single batch, coloured by the state of the component driving them
+  Rectangle white = this->atlas.white;
+  bool thin = this->camera.zoom < this->lod.wireZoom;
+  rlSetTexture(this->atlas.texture.id);
+  rlBegin(thin ? RL_LINES : RL_TRIANGLES);
+  rlTexCoord2f((white.x + 0.5f) / this->atlas.texture.width, (white.y + 0.5f) / this->atlas.texture.height);
+  for (InputPin* input : this->visibleWires) {
+    if (input->child->self->state)rlColor4ub(255, 29, 13, 255);
+    else rlColor4ub(110, 168, 74, 255);
+    if (thin) {
+      // Zoomed far out the bends are sub-pixel, a straight line between the pins is enough
+      Vector2 start = input->wire[0], end = input->wire[3];
+      rlVertex2f(start.x, start.y);
+      rlVertex2f(end.x, end.y);
+      continue;
+    }
+    const Vector2* vertex = this->wireVertices.data() + input->wireIndex * WIRE_VERTICES;
+    for (int i = 0;i < WIRE_VERTICES;i++)rlVertex2f(vertex[i].x, vertex[i].y);
+  }
+  rlEnd();
+  rlSetTexture(0);
 }
 
 void Board::Draw() {
   // DrawRectangleRec(this->dimension, RED);
-  for (auto& it : this->components) {
-    it.second->Draw();
-    this->DrawConnection(it.second); // NOTE: This Line is added here after rewritting the DrawConnection Method
+  // Only what the spatial index finds inside the visible part of the canvas gets drawn
+  Rectangle viewport = this->GetViewport();
+  Rectangle area = this->GetVisibleArea();
+  this->grid.QueryRect(area, this->visible);
+  std::sort(this->visible.begin(), this->visible.end(), [](Component* a, Component* b) { return a->netNode < b->netNode; });
+  BeginScissorMode((int)viewport.x, (int)viewport.y, (int)viewport.width, (int)viewport.height);
+  BeginMode2D(this->camera);
+  if (this->camera.zoom < this->lod.spriteZoom) {
+    for (Component* comp : this->visible)DrawRectangleV(comp->position, comp->size, comp->GetLodColor());
   }
+  else {
+    for (Component* comp : this->visible)comp->Draw();
+  }
+  this->DrawWires(area);
   if (this->inputPin != nullptr && this->outputPin != nullptr) {
     DrawLineManhattan(this->inputPin->position, this->outputPin->position, 2.0f, BLACK, ManhattanBendStyle::BendAtMidpoint);
   }
@@ -182,165 +275,185 @@ void Board::Draw() {
     DrawCircleV(this->inputPin->position, 7, GREEN);
   }
   if (this->outputPin != nullptr)DrawCircleV(this->outputPin->position, 7, GREEN);
+  EndMode2D();
+  EndScissorMode();
   this->dropDown->Draw();
 
 }
 void Board::Update() {
-  for (auto& it : this->components) {
-    it.second->Update();
-    if (this->simulationRunning &&
-      typeid(*(it.second)) == typeid(Switch) &&
-      IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) &&
-      CheckCollisionPointRec(GetMousePosition(), { it.second->position.x,it.second->position.y,it.second->size.x,it.second->size.y })) {
-      dynamic_cast<Switch*>(it.second)->ToggleState();
+  this->UpdateGeometry();
+  this->UpdateCamera();
+  // Clicks only look at the components filed under the grid cell of the mouse, in board order
+  bool inside = CheckCollisionPointRec(GetMousePosition(), this->GetViewport());
+  bool leftPressed = inside && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+  bool rightPressed = inside && IsMouseButtonPressed(MOUSE_RIGHT_BUTTON);
+  Vector2 mouse = this->ScreenToWorld(GetMousePosition());
+  this->hits.clear();
+  if (leftPressed || rightPressed) {
+    this->grid.QueryPoint(mouse, this->hits);
+    std::sort(this->hits.begin(), this->hits.end(), [](Component* a, Component* b) { return a->netNode < b->netNode; });
+  }
+  for (Component* comp : this->hits) {
+    if (leftPressed)comp->HandleInput(this->events, mouse);
+    if (!rightPressed || !this->simulationRunning ||
+      !CheckCollisionPointRec(mouse, { comp->position.x,comp->position.y,comp->size.x,comp->size.y }))continue;
+    if (typeid(*comp) == typeid(Switch)) {
+      dynamic_cast<Switch*>(comp)->ToggleState();
+      this->RecordEdit({ EDIT_STATE, comp->id, "", comp->state });
+      if (this->simThread.IsRunning() && !this->netlistDirty)this->simThread.SetSource(comp->netNode, comp->state);
     }
-    else if (this->simulationRunning &&
-      typeid(*(it.second)) == typeid(Clock) &&
-      IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) &&
-      CheckCollisionPointRec(GetMousePosition(), { it.second->position.x,it.second->position.y,it.second->size.x,it.second->size.y })) {
-      dynamic_cast<Clock*>(it.second)->ToggleState();
+    else if (typeid(*comp) == typeid(Clock)) {
+      dynamic_cast<Clock*>(comp)->ToggleState();
+      int hertz = dynamic_cast<Clock*>(comp)->hertz;
+      if (!this->netlistDirty)this->clocks.SetClock(comp->netNode, hertz, comp->state);
+      if (this->simThread.IsRunning() && !this->netlistDirty)this->simThread.SetClock(comp->netNode, hertz);
     }
   }
   if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && this->activeComponent != nullptr) {
+    // The canvas is unbounded, the mouse movement is only scaled back to world units
     Vector2 delta = GetMouseDelta();
-    float posX = this->activeComponent->position.x + delta.x;
-    float posY = this->activeComponent->position.y + delta.y;
-    if (posX < this->GetCoordinates({ 0,0 }).x)posX = this->GetCoordinates({ 0,0 }).x;
-    else if (posX > this->GetCoordinates({ 0,0 }).x + this->dimension.width - this->activeComponent->size.x)posX = this->GetCoordinates({ 0,0 }).x + this->dimension.width - this->activeComponent->size.x;
-
-    if (posY < this->GetCoordinates({ 0,0 }).y)posY = this->GetCoordinates({ 0,0 }).y;
-    else if (posY > this->GetCoordinates({ 0,0 }).y + this->dimension.height - this->activeComponent->size.y + 20)posY = this->GetCoordinates({ 0,0 }).y + this->dimension.height - this->activeComponent->size.y + 20;
-
-
-    this->activeComponent->position = {
-      posX,
-      posY
-    };
+    this->MoveComponent(this->activeComponent, {
+      this->activeComponent->position.x + delta.x / this->camera.zoom,
+      this->activeComponent->position.y + delta.y / this->camera.zoom
+      });
   }
   if (IsMouseButtonUp(MOUSE_LEFT_BUTTON))this->activeComponent = nullptr;
   if (this->inputPin != nullptr && this->outputPin != nullptr) {
     // Connect the Pins
     if (this->inputPin->child == nullptr) {
-      this->inputPin->child = this->outputPin;
-      this->outputPin->parent->push_back(this->inputPin);
+      this->ConnectPins(this->inputPin, this->outputPin);
       this->heads.erase(std::remove(this->heads.begin(), this->heads.end(), this->outputPin->self->id), this->heads.end());
-      // std::cout << "Pins Connected: " << this->inputPin->self->id << " " << this->outputPin->self->id << std::endl;
-      // Printing all the Head Components
-      //for (std::string ids : this->heads)std::cout << ids << " ";
-      //std::cout << std::endl;
-    }
-    else {
-      //std::cout << "Can't Connect Pins\n";
     }
     this->inputPin = nullptr;
     this->outputPin = nullptr;
   }
 
-  if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) {
-    //std::cout << "Right Click\n";
-    Vector2 pos = GetMousePosition();
-    for (auto it : this->components) {
-      Component* comp = it.second;
-      if (CheckCollisionPointRec(pos, { comp->position.x,comp->position.y,comp->size.x,comp->size.y }) && !this->simulationRunning) {
+  if (rightPressed) {
+    for (Component* comp : this->hits) {
+      if (CheckCollisionPointRec(mouse, { comp->position.x,comp->position.y,comp->size.x,comp->size.y }) && !this->simulationRunning) {
         this->dropDown->SetComponent(comp);
         break;
       }
     }
   }
-  if (this->simulationRunning)this->Simulate();
+  this->UpdateGeometry();
+  // Saves finish on the saver thread, only the successful ones make it into the recent projects
+  SaveResult result;
+  while (this->saver.PollResult(result)) {
+    if (result.success)ProjectList::Insert({ GetFileNameWithoutExt(result.fileName.c_str()), result.fileName });
+    else if (result.fileName == this->boardFile)this->canAppend = false;
+  }
+  if (!this->edits.empty() && GetTime() - this->lastAutosave >= AUTOSAVE_INTERVAL)this->FlushJournal();
+  if (this->simulationRunning && this->threadedSimulation)this->SyncSimulationThread();
+  else if (this->simulationRunning)this->Simulate();
+  else if (this->simThread.IsRunning())this->simThread.Stop();
 
 }
-void Board::InsertGate(std::string compId, GateType type, Texture texture) {
+// Save format code of a component
+static int TypeCode(Component* comp) {
+  if (typeid(*comp) == typeid(Switch)) return CODE_SWITCH;
+  if (typeid(*comp) == typeid(Bulb)) return CODE_BULB;
+  if (typeid(*comp) == typeid(Clock)) return CODE_CLOCK;
+  if (typeid(*comp) == typeid(Gate)) return GateCode(static_cast<Gate*>(comp)->type);
+  return CODE_AND;
+}
+// Appends a single unconnected component to the netlist description
+static int AddNetNode(NetDescription& description, Component* comp) {
+  if (typeid(*comp) == typeid(Switch) || typeid(*comp) == typeid(Clock))return description.AddNode(NODE_SOURCE, AND, (int)comp->outputs->size(), comp->state, 0);
+  if (typeid(*comp) == typeid(Bulb))return description.AddNode(NODE_SINK, AND, 0, comp->state, (int)comp->inputs->size());
+  return description.AddNode(NODE_GATE, static_cast<Gate*>(comp)->type, (int)comp->outputs->size(), comp->state, (int)comp->inputs->size());
+}
+SlotHandle Board::AddComponent(Component* comp) {
+  comp->handle = this->components.Insert(comp);
+  comp->netNode = AddNetNode(this->netNodes, comp);
+  this->grid.Insert(comp, comp->GetBounds());
+  this->MarkMoved(comp);
+  this->heads.push_back(comp->id);
+  this->netlistDirty = true;
+  this->RecordEdit({ EDIT_INSERT, comp->id, "", TypeCode(comp), comp->position.x, comp->position.y });
+  return comp->handle;
+}
+Component* Board::GetComponent(SlotHandle handle) {
+  Component** comp = this->components.Get(handle);
+  return comp ? *comp : nullptr;
+}
+SlotHandle Board::InsertGate(std::string compId, GateType type, Sprite sprite) {
   std::string id = compId.empty() ? generateUniqueId("Gate") : compId;
-  this->components[id] = new Gate(type, texture, id, this->GetCoordinates({ 50,50 }));
-  this->components[id]->Register("select", [this, id](void*) {
-    this->activeComponent = this->components[id];
-    });
-
-  this->components[id]->Register("inputPin", [this](void* pin) {
-    std::cout << "Input Pin Selected" << std::endl;
-    this->inputPin = (InputPin*)pin;
-    });
-
-  this->components[id]->Register("outputPin", [this](void* pin) {
-    std::cout << "Output Pin Selected" << std::endl;
-    this->outputPin = (OutputPin*)pin;
-    std::cout << this->outputPin->self->id << std::endl;
-    });
-
-  this->heads.push_back(id);
-  std::cout << id << std::endl;
+  return this->AddComponent(this->arena.New<Gate>(&this->arena, type, sprite, id, this->ScreenToWorld(this->GetCoordinates({ 50,50 }))));
 }
-void Board::InsertSwitch(std::string compId, Texture on, Texture off) {
+SlotHandle Board::InsertSwitch(std::string compId, Sprite on, Sprite off) {
   std::string id = compId.empty() ? generateUniqueId("Switch") : compId;
-  this->components[id] = new Switch(id, on, off, this->GetCoordinates({ 50,50 }));
-  this->components[id]->Register("select", [this, id](void*) {
-    this->activeComponent = this->components[id];
-    });
-  this->components[id]->Register("inputPin", [this](void* pin) {
-    std::cout << "Input Pin Selected" << std::endl;
-    this->inputPin = (InputPin*)pin;
-    });
-
-  this->components[id]->Register("outputPin", [this](void* pin) {
-    std::cout << "Output Pin Selected" << std::endl;
-    this->outputPin = (OutputPin*)pin;
-    std::cout << this->outputPin->self->id << std::endl;
-    });
-  this->heads.push_back(id);
-  std::cout << id << std::endl;
+  return this->AddComponent(this->arena.New<Switch>(&this->arena, id, on, off, this->ScreenToWorld(this->GetCoordinates({ 50,50 }))));
 }
-void Board::InsertClock(std::string compId) {
+SlotHandle Board::InsertClock(std::string compId) {
   std::string id = compId.empty() ? generateUniqueId("Clock") : compId;
-  std::map<int, Texture> texture;
-  texture[1] = this->textures["clock_1"];
-  texture[5] = this->textures["clock_5"];
-  texture[10] = this->textures["clock_10"];
-  texture[30] = this->textures["clock_30"];
-  texture[60] = this->textures["clock_60"];
-
-  this->components[id] = new Clock(id, texture, this->GetCoordinates({ 50,50 }));
-  this->components[id]->Register("select", [this, id](void*) {
-    this->activeComponent = this->components[id];
-    });
-  this->components[id]->Register("inputPin", [this](void* pin) {
-    std::cout << "Input Pin Selected" << std::endl;
-    this->inputPin = (InputPin*)pin;
-    });
-
-  this->components[id]->Register("outputPin", [this](void* pin) {
-    std::cout << "Output Pin Selected" << std::endl;
-    this->outputPin = (OutputPin*)pin;
-    std::cout << this->outputPin->self->id << std::endl;
-    });
-  this->heads.push_back(id);
-  std::cout << id << std::endl;
+  std::map<int, Sprite> texture;
+  texture[1] = this->atlas.Get("clock_1");
+  texture[5] = this->atlas.Get("clock_5");
+  texture[10] = this->atlas.Get("clock_10");
+  texture[30] = this->atlas.Get("clock_30");
+  texture[60] = this->atlas.Get("clock_60");
+  return this->AddComponent(this->arena.New<Clock>(&this->arena, id, texture, this->ScreenToWorld(this->GetCoordinates({ 50,50 }))));
 }
-void Board::InsertBulb(std::string compId, Texture on, Texture off) {
+SlotHandle Board::InsertBulb(std::string compId, Sprite on, Sprite off) {
   std::string id = compId.empty() ? generateUniqueId("Bulb") : compId;
-  this->components[id] = new Bulb(id, on, off, this->GetCoordinates({ 50,50 }));
-  this->components[id]->Register("select", [this, id](void*) {
-    this->activeComponent = this->components[id];
-    });
-  this->components[id]->Register("inputPin", [this](void* pin) {
-    std::cout << "Input Pin Selected" << std::endl;
-    this->inputPin = (InputPin*)pin;
-    });
-
-  this->components[id]->Register("outputPin", [this](void* pin) {
-    std::cout << "Output Pin Selected" << std::endl;
-    this->outputPin = (OutputPin*)pin;
-    std::cout << this->outputPin->self->id << std::endl;
-    });
-  this->heads.push_back(id);
-  std::cout << id << std::endl;
+  return this->AddComponent(this->arena.New<Bulb>(&this->arena, id, on, off, this->ScreenToWorld(this->GetCoordinates({ 50,50 }))));
+}
+void Board::FreeComponent(Component* comp) {
+  // The destructor hands the pins and fan-out lists back to the arena, the component block follows
+  this->arena.Delete(comp);
+}
+void Board::MoveComponent(Component* comp, Vector2 position) {
+  if (comp->position.x == position.x && comp->position.y == position.y)return;
+  comp->position = position;
+  this->grid.Move(comp, comp->GetBounds());
+  this->MarkMoved(comp);
+  this->RecordEdit({ EDIT_MOVE, comp->id, "", 0, position.x, position.y });
+}
+void Board::MarkMoved(Component* comp) {
+  if (comp->pinsDirty)return;
+  comp->pinsDirty = true;
+  this->moved.push_back(comp);
+}
+void Board::UpdateGeometry() {
+  // Lay out the pins of everything that moved first, the wires read the pins on both ends
+  for (Component* comp : this->moved) {
+    comp->LayoutPins();
+    comp->pinsDirty = false;
+  }
+  for (Component* comp : this->moved) {
+    for (auto& input : *(comp->inputs)) {
+      if (input.child)this->RerouteWire(input);
+    }
+    for (auto& output : *(comp->outputs)) {
+      for (auto* input : *(output.parent))this->RerouteWire(*input);
+    }
+  }
+  this->moved.clear();
+}
+void Board::RerouteWire(InputPin& input) {
+  // Only the cells and triangles of this connection change, the rest of the batch stays as it is
+  RouteWire(input);
+  this->wireGrid.Move(&input, WireBounds(input));
+  if (!this->wiresDirty)WriteWire(this->wireVertices.data() + input.wireIndex * WIRE_VERTICES, input);
+}
+void Board::ConnectPins(InputPin* input, OutputPin* output) {
+  input->child = output;
+  output->parent->push_back(input);
+  RouteWire(*input);
+  this->wireGrid.Insert(input, WireBounds(*input));
+  this->wiresDirty = true;
+  this->netNodes.Inputs(input->self->netNode)[input->pinNo] = { output->self->netNode, output->pinNo };
+  this->PatchNetlist(input->self->netNode, input->pinNo);
+  this->RecordEdit({ EDIT_CONNECT, input->self->id, output->self->id, 0, 0, 0, input->pinNo, output->pinNo });
 }
 void Board::DeleteComponent(Component* comp) {
+  this->RecordEdit({ EDIT_DELETE, comp->id });
   // Disconnect all input pins
   if (comp->inputs) {
-    //std::cout << "Disconnecting Inputs\n";
     for (auto& input : *(comp->inputs)) {
       if (input.child) {
+        this->wireGrid.Remove(&input);
         // Remove this input from the parent's parent vector
         auto& parents = *(input.child->parent);
         parents.erase(std::remove(parents.begin(), parents.end(), &input), parents.end());
@@ -351,12 +464,13 @@ void Board::DeleteComponent(Component* comp) {
 
   // Disconnect all output pins
   if (comp->outputs) {
-    //std::cout << "Disconnecting Outputs\n";
     for (auto& output : *(comp->outputs)) {
       if (output.parent) {
         for (auto* input : *(output.parent)) {
           if (input->child == &output) {
+            this->wireGrid.Remove(input);
             input->child = nullptr;
+            this->netNodes.Inputs(input->self->netNode)[input->pinNo] = { -1, 0 };
           }
         }
         output.parent->clear();
@@ -364,24 +478,26 @@ void Board::DeleteComponent(Component* comp) {
     }
   }
 
-  // Remove from components map
-  //std::cout << "Removing from map\n";
-  for (auto it = components.begin(); it != components.end(); ++it) {
-    if (it->second == comp) {
-      components.erase(it);
-      break;
+  this->grid.Remove(comp);
+  if (comp->pinsDirty)this->moved.erase(std::remove(this->moved.begin(), this->moved.end(), comp), this->moved.end());
+  // Remove from the slot map, the last component moves into its place and its readers are pointed at the new index
+  int dense = comp->netNode;
+  this->components.Erase(comp->handle);
+  this->netNodes.RemoveNode(dense);
+  if (dense < (int)this->components.Size()) {
+    Component* moved = this->components.values[dense];
+    moved->netNode = dense;
+    for (auto& output : *(moved->outputs)) {
+      for (auto* input : *(output.parent))this->netNodes.Inputs(input->self->netNode)[input->pinNo].node = dense;
     }
   }
-  //std::cout << "Removing from heads\n";
   this->heads.erase(std::remove(this->heads.begin(), this->heads.end(), comp->id), this->heads.end());
   // Delete the component
-  delete comp;
-  //std::cout << "Component Deleted\n";
+  this->FreeComponent(comp);
 
   // Update the Heads list
   this->heads.clear();
-  for (auto& it : this->components) {
-    Component* c = it.second;
+  for (Component* c : this->components) {
     bool isHead = true;
     for (auto& pin : *(c->outputs)) {
       if (!pin.parent->empty()) {
@@ -396,28 +512,29 @@ void Board::DeleteComponent(Component* comp) {
   if (this->inputPin != nullptr && this->inputPin->self == comp)this->inputPin = nullptr;
   if (this->outputPin != nullptr && this->outputPin->self == comp)this->outputPin = nullptr;
   if (this->activeComponent == comp)this->activeComponent = nullptr;
+  this->netlistDirty = true;
+  this->wiresDirty = true;
 
 }
 void Board::DeleteConnection(Component* comp, int pin) {
   if (comp != nullptr) {
     InputPin input = (*comp->inputs)[pin];
-    //std::cout << "Self: " << input.self->id << std::endl;
     if (input.child) {
-      //std::cout << "Child: " << input.child->self->id << std::endl;
       // Remove this input from the parent's parent vector
       auto& parents = *(input.child->parent);
-      //std::cout << "Length: " << parents.size() << std::endl;
       parents.erase(std::remove(parents.begin(), parents.end(), &(*comp->inputs)[pin]), parents.end());
-      //std::cout << "Length: " << parents.size() << std::endl;
+      this->wireGrid.Remove(&(*comp->inputs)[pin]);
       (*comp->inputs)[pin].child = nullptr;
+      this->netNodes.Inputs(comp->netNode)[pin] = { -1, 0 };
+      this->RecordEdit({ EDIT_DISCONNECT, comp->id, "", 0, 0, 0, pin });
+      this->PatchNetlist(comp->netNode, pin);
+      this->wiresDirty = true;
     }
   }
 
   // Update the Heads list
-  //std::cout << "Head Length: " << this->heads.size() << std::endl;
   this->heads.clear();
-  for (auto& it : this->components) {
-    Component* c = it.second;
+  for (Component* c : this->components) {
     bool isHead = true;
     for (auto& pin : *(c->outputs)) {
       if (!pin.parent->empty()) {
@@ -427,8 +544,6 @@ void Board::DeleteConnection(Component* comp, int pin) {
     }
     if (isHead)this->heads.push_back(c->id);
   }
-  //std::cout << "Head Length: " << this->heads.size() << std::endl;
-  //std::cout << "Pin Disconnected\n";
 }
 void Board::PrintBoard() {
   // for (int i = 0;i < 50;i++)std::cout << "-";
@@ -497,207 +612,423 @@ void Board::PrintBoard() {
   // for (int i = 0;i < 50;i++)std::cout << "-";
   // std::cout << std::endl;
 }
+Rectangle Board::GetViewport() {
+  // The canvas reaches into the bottom margin of its group box, like the old drag limits did
+  return { this->dimension.x,this->dimension.y,this->dimension.width,this->dimension.height + 20 };
+}
+Rectangle Board::GetVisibleArea() {
+  Rectangle viewport = this->GetViewport();
+  Vector2 topLeft = this->ScreenToWorld({ viewport.x,viewport.y });
+  return { topLeft.x,topLeft.y,viewport.width / this->camera.zoom,viewport.height / this->camera.zoom };
+}
+Vector2 Board::ScreenToWorld(Vector2 point) {
+  return GetScreenToWorld2D(point, this->camera);
+}
+void Board::UpdateCamera() {
+  Vector2 mouse = GetMousePosition();
+  if (!CheckCollisionPointRec(mouse, this->GetViewport()))return;
+  // Pan with the middle button
+  if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) {
+    Vector2 delta = GetMouseDelta();
+    this->camera.target.x -= delta.x / this->camera.zoom;
+    this->camera.target.y -= delta.y / this->camera.zoom;
+  }
+  // Zoom with the wheel, the point under the mouse stays put
+  float wheel = GetMouseWheelMove();
+  if (wheel != 0) {
+    Vector2 anchor = this->ScreenToWorld(mouse);
+    this->camera.offset = mouse;
+    this->camera.target = anchor;
+    this->camera.zoom *= 1.0f + 0.1f * wheel;
+    if (this->camera.zoom < MIN_ZOOM)this->camera.zoom = MIN_ZOOM;
+    else if (this->camera.zoom > MAX_ZOOM)this->camera.zoom = MAX_ZOOM;
+  }
+}
 Vector2 Board::GetCoordinates(Vector2 coordinate) {
   return Vector2{
     coordinate.x + this->dimension.x,
     coordinate.y + this->dimension.y
   };
 }
+void Board::CompileNetlist() {
+  // The node description is maintained on every edit, only the states need refreshing before the compile
+  this->nodes.assign(this->components.begin(), this->components.end());
+  for (size_t i = 0;i < this->nodes.size();i++)this->netNodes.nodes[i].state = this->nodes[i]->state;
+  this->netlist.Compile(this->netNodes);
+  this->netlistDirty = false;
+  this->netlistPatched = false;
+  // Clock phases restart on every compile, the virtual time itself carries on
+  this->clocks.Reset((int)this->nodes.size());
+  for (size_t i = 0;i < this->nodes.size();i++) {
+    if (typeid(*this->nodes[i]) == typeid(Clock))this->clocks.SetClock((int)i, dynamic_cast<Clock*>(this->nodes[i])->hertz, this->nodes[i]->state);
+  }
+  // The event driven mode starts from a fully dirty netlist so everything settles once
+  if (this->simulationMode == SIM_EVENT_DRIVEN)this->netlist.ScheduleAll();
+}
+// Connecting or disconnecting a pin only rewrites its fan-in entry when the level order allows it
+void Board::PatchNetlist(int node, int pin) {
+  if (this->netlistDirty)return;
+  if (this->netlist.Reconnect(this->netNodes, node, pin))this->netlistPatched = true;
+  else this->netlistDirty = true;
+}
+void Board::SetSimulationMode(SimulationMode mode) {
+  if (mode == this->simulationMode)return;
+  this->simulationMode = mode;
+  this->simThread.SetEventDriven(mode == SIM_EVENT_DRIVEN);
+  if (mode == SIM_EVENT_DRIVEN && !this->netlistDirty)this->netlist.ScheduleAll();
+}
 void Board::Simulate() {
-  for (std::string id : (this->heads)) {
-    Component* comp = this->components[id];
-    std::map<Component*, bool> map;
-    map[comp] = true;
-    comp->GetState(map);
-    map[comp] = false;
-  }
-}
-std::string Board::Serialize() {
-  /**
-   * 1. Switch
-   * 2. Bulb
-   * 3. Cock
-   * 4. AND Gate
-   * 5. OR Gate
-   * 6. NOT Gate
-   * 7. NAND Gate
-   * 8. NOR Gate
-   * 9. XOR Gate
-   */
-   // Components
-
-  std::string board = "";
-  if (this->components.empty()) {
-    // std::cout << board;
-    // for (int i = 0;i < 50;i++)std::cout << "-";
-    // std::cout << std::endl;
-    return board;
-  }
-  for (auto it : this->components) {
-    Component* comp = it.second;
-    board.append(comp->id).append(",");
-    int type;
-    if (typeid(*comp) == typeid(Switch)) type = 1;
-    else if (typeid(*comp) == typeid(Bulb)) type = 2;
-    else if (typeid(*comp) == typeid(Clock)) type = 3;
-    else if (typeid(*comp) == typeid(Gate)) {
-      Gate* gate = static_cast<Gate*>(comp);
-      if (gate->type == AND) type = 4;
-      else if (gate->type == OR) type = 5;
-      else if (gate->type == NOT) type = 6;
-      else if (gate->type == NAND) type = 7;
-      else if (gate->type == NOR) type = 8;
-      else if (gate->type == XOR) type = 9;
+  if (this->netlistDirty)this->CompileNetlist();
+  // Advance the virtual time by one tick and fire the Clock edges that fall inside it
+  std::vector<int> toggled;
+  this->clocks.AdvanceTo(this->clocks.now + this->tickPeriod, toggled);
+  for (int node : toggled)this->nodes[node]->state = this->clocks.GetState(node);
+  if (this->simulationMode == SIM_EVENT_DRIVEN) {
+    // Only the fan-out of the Switches and Clocks that changed gets re-evaluated
+    for (int node : this->netlist.sources) {
+      this->netlist.DriveSource(node, this->nodes[node]->state);
     }
-    board.append(std::to_string(type)).append(",");
-    board.append(std::to_string(comp->position.x)).append(",");
-    board.append(std::to_string(comp->position.y)).append(",");
-    board.append(std::to_string(comp->inputCount)).append(",");
-    board.append(std::to_string(comp->outputCount)).append(",");
-    board.append((comp->state ? "1" : "0")).append(";");
-  }
-  board.append("|");
-  // Connections
-  for (auto it : this->components) {
-    Component* comp = it.second;
-    for (auto ipin : (*comp->inputs)) {
-      board.append(comp->id).append(","); // To
-      board.append((ipin.child ? ipin.child->self->id : "-")).append(","); // From
-      board.append(std::to_string(ipin.pinNo)).append(","); // toPin Number
-      board.append((ipin.child ? std::to_string(ipin.child->pinNo) : "-")).append(";");
+    this->netlist.Propagate();
+    for (int node : this->netlist.changed)this->nodes[node]->state = this->netlist.GetState(node);
+    this->netlist.changed.clear();
+    return;
+  }
+  // Sample the Switches and Clocks, then evaluate the whole board once in level order
+  for (int node : this->netlist.sources) {
+    this->netlist.SetSource(node, this->nodes[node]->state);
+  }
+  this->netlist.Evaluate();
+  for (size_t i = 0;i < this->nodes.size();i++) {
+    this->nodes[i]->state = this->netlist.GetState((int)i);
+  }
+}
+void Board::SyncSimulationThread() {
+  // Hand every new netlist over to the simulation thread along with the Clock frequencies
+  if (this->netlistDirty || this->netlistPatched || !this->simThread.IsRunning()) {
+    if (this->netlistDirty)this->CompileNetlist();
+    // A patched netlist keeps its nets, it carries on from the values the thread last published
+    else if (this->netlistPatched && this->snapshot.generation == this->simGeneration && this->snapshot.values.size() == this->netlist.values.size()) {
+      this->netlist.values = this->snapshot.values;
+    }
+    this->netlistPatched = false;
+    std::vector<double> clockHertz(this->nodes.size(), 0.0);
+    for (size_t i = 0;i < this->nodes.size();i++) {
+      if (typeid(*this->nodes[i]) == typeid(Clock))clockHertz[i] = dynamic_cast<Clock*>(this->nodes[i])->hertz;
+      else if (typeid(*this->nodes[i]) == typeid(Switch))this->netlist.SetSource((int)i, this->nodes[i]->state);
     }
+    this->simGeneration = this->simThread.Load(this->netlist, clockHertz, this->simulationMode == SIM_EVENT_DRIVEN);
+    this->simThread.Start();
   }
-  board.append("|");
-  // Heads
-  for (int i = 0;i < this->heads.size() - 1;i++) {
-    board.append(this->heads[i]).append(",");
+  // Show the newest published net values, snapshots of an older netlist no longer match the nodes
+  if (this->simThread.ReadSnapshot(this->snapshot) && this->snapshot.generation == this->simGeneration) {
+    for (size_t i = 0;i < this->nodes.size();i++) {
+      this->nodes[i]->state = this->snapshot.values[this->netlist.nodeValue[i]];
+    }
   }
-  board.append(this->heads[this->heads.size() - 1]);
-  return board;
 }
-void Board::Deserialize(std::string fileName) {
-  std::ifstream file(fileName);
-  std::string board;
-  file >> board; // Read the string as the file doesn't contains any newline character
-  file.close();
-  std::vector<std::string> sections = splitStringByDelimiter(board, "|");
-  //std::cout << "Sections Size: " << sections.size() << std::endl;
-  // Load Components First
-  if (sections[0].size() != 0) {
-    //std::cout << "Loading Components..." << std::endl;
-    std::vector<std::string> componentsStr = splitStringByDelimiter(sections[0], ";");
-    for (int i = 0;i < componentsStr.size() - 1;i++) {
-      std::string comp = componentsStr[i];
-      std::vector<std::string> values = splitStringByDelimiter(comp, ",");
-      std::string id = values[0];
-      int type = atoi(values[1].c_str());
-      float posX = atof(values[2].c_str());
-      float posY = atof(values[3].c_str());
-      int inputCount = atoi(values[4].c_str());
-      int outputCount = atoi(values[5].c_str());
-      bool state = values[6] == "1" ? true : false;
-      if (type == 1) {
-        this->InsertSwitch(id, this->textures["switch_on"], this->textures["switch_off"]);
-      }
-      else if (type == 2) {
-        this->InsertBulb(id, this->textures["bulb_on"], this->textures["bulb_off"]);
-      }
-      else if (type == 3) {
-        this->InsertClock(id);
-      }
-      else if (type == 4) {
-        this->InsertGate(id, AND, this->textures["and"]);
-      }
-      else if (type == 5) {
-        this->InsertGate(id, OR, this->textures["or"]);
-      }
-      else if (type == 6) {
-        this->InsertGate(id, NOT, this->textures["not"]);
-      }
-      else if (type == 7) {
-        this->InsertGate(id, NAND, this->textures["nand"]);
-      }
-      else if (type == 8) {
-        this->InsertGate(id, NOR, this->textures["nor"]);
-      }
-      else if (type == 9) {
-        this->InsertGate(id, XOR, this->textures["xor"]);
-      }
-      else {
-        //std::cout << "Invalid Gate Found\n";
-        this->components.clear();
-        this->heads.clear();
-        return;
+bool Board::SweepTruthTable(TruthTable& table) {
+  // Every Switch and Clock is an input and every Bulb an output, the node indices map back through this->nodes
+  if (this->netlistDirty)this->CompileNetlist();
+  return ::SweepTruthTable(this->netlist, table);
+}
+// Components of a board for WriteBinaryBoard, the dense order of Board::components is the netNode order
+// so a component's index is its netNode
+class ComponentSource :public BinaryBoardSource {
+public:
+  Board* board;
+  uint32_t component; // Position of the connection cursor
+  size_t pin;
+  ComponentSource(Board* board) {
+    this->board = board;
+    this->component = 0;
+    this->pin = 0;
+  }
+  uint32_t ComponentCount() override {
+    return (uint32_t)this->board->components.Size();
+  }
+  std::string_view Id(uint32_t component) override {
+    return this->board->components.values[component]->id;
+  }
+  void GetComponent(uint32_t component, BinaryComponent& record) override {
+    Component* comp = this->board->components.values[component];
+    record.x = comp->position.x;
+    record.y = comp->position.y;
+    record.inputCount = (uint16_t)comp->inputCount;
+    record.outputCount = (uint16_t)comp->outputCount;
+    record.type = (uint8_t)TypeCode(comp);
+    record.state = comp->state;
+  }
+  void StartConnections() override {
+    this->component = 0;
+    this->pin = 0;
+  }
+  bool NextConnection(BinaryConnection& record) override {
+    while (this->component < this->board->components.Size()) {
+      Component* comp = this->board->components.values[this->component];
+      while (this->pin < comp->inputs->size()) {
+        const InputPin& ipin = (*comp->inputs)[this->pin++];
+        if (!ipin.child)continue;
+        record = { (uint32_t)comp->netNode, (uint32_t)ipin.child->self->netNode, (uint16_t)ipin.pinNo, (uint16_t)ipin.child->pinNo };
+        return true;
       }
-      //std::cout << this->components.size() << std::endl;
-      this->components[id]->position = { posX,posY };
-      this->components[id]->inputCount = inputCount;
-      this->components[id]->outputCount = outputCount;
-      this->components[id]->state = state;
+      this->component++;
+      this->pin = 0;
     }
-    //std::cout << "Successfully Loaded Components\n";
+    return false;
   }
-  // Load the Connections
-  //std::cout << sections[1] << std::endl;
-  if (sections[1].size() != 0) {
-    //std::cout << "Loading Connections" << std::endl;
-    std::vector<std::string> connectionData = splitStringByDelimiter(sections[1], ";");
-    for (int i = 0;i < connectionData.size() - 1;i++) {
-      std::string connectionStr = connectionData[i];
-      //std::cout << connectionStr << std::endl;
-      std::vector<std::string> tokens = splitStringByDelimiter(connectionStr, ",");
-      if (tokens[1] == "-" || tokens[3] == "-")continue;
-      else {
-        int from = atoi(tokens[3].c_str());
-        int to = atoi(tokens[2].c_str());
-        Component* toComp = this->components[tokens[0]];
-        InputPin* inputPin = &(*toComp->inputs)[to];
-        Component* fromComp = this->components[tokens[1]];
-        OutputPin* outputPin = &(*fromComp->outputs)[from];
-        if (&(*toComp->inputs)[to] != nullptr && &(*fromComp->outputs)[from] != nullptr) {
-          if ((*toComp->inputs)[to].child == nullptr) {
-            (*toComp->inputs)[to].child = &(*fromComp->outputs)[from];
-            (*fromComp->outputs)[from].parent->push_back(&(*toComp->inputs)[to]);
-            //std::cout << "Pins Connected: " << fromComp->id << " " << toComp->id << std::endl;
-          }
-          else {
-            //std::cout << "Can't Connect Pins\n";
-          }
-        }
-      }
-      //std::cout << "Connections Loaded Successfully" << std::endl;
+  const std::vector<std::string>& Heads() override {
+    return this->board->heads;
+  }
+};
+void Board::Snapshot(std::string& image) {
+  // The binary image is a few flat copies, cheap enough for the UI thread, and the saver can write either format from it
+  BufferedWriter out(&image);
+  ComponentSource source(this);
+  WriteBinaryBoard(out, source);
+  out.Flush();
+}
+Component* Board::CreateComponent(int code, const std::string& id, Vector2 position) {
+  GateType type;
+  SlotHandle handle = INVALID_SLOT;
+  if (code == CODE_SWITCH) {
+    handle = this->InsertSwitch(id, this->atlas.Get("switch_on"), this->atlas.Get("switch_off"));
+  }
+  else if (code == CODE_BULB) {
+    handle = this->InsertBulb(id, this->atlas.Get("bulb_on"), this->atlas.Get("bulb_off"));
+  }
+  else if (code == CODE_CLOCK) {
+    handle = this->InsertClock(id);
+  }
+  else if (CodeToGate(code, type)) {
+    static const char* textureNames[] = { "and", "or", "not", "nor", "nand", "xor" };
+    handle = this->InsertGate(id, type, this->atlas.Get(textureNames[type]));
+  }
+  Component* comp = this->GetComponent(handle);
+  if (comp)this->MoveComponent(comp, position);
+  return comp;
+}
+Component* Board::LoadComponent(const ComponentRecord& record) {
+  Component* comp = this->CreateComponent(record.type, record.id, { record.x,record.y });
+  if (comp == nullptr)return nullptr;
+  // The counts always follow the pins the component was built with, the ones in the file are not trusted
+  comp->inputCount = (int)comp->inputs->size();
+  comp->outputCount = (int)comp->outputs->size();
+  comp->state = record.state;
+  return comp;
+}
+void Board::LoadConnection(Component* to, int toPin, Component* from, int fromPin) {
+  if (to == nullptr || from == nullptr)return;
+  if (toPin < 0 || toPin >= (int)to->inputs->size())return;
+  if (fromPin < 0 || fromPin >= (int)from->outputs->size())return;
+  if ((*to->inputs)[toPin].child == nullptr) {
+    this->ConnectPins(&(*to->inputs)[toPin], &(*from->outputs)[fromPin]);
+  }
+}
+void Board::Deserialize(std::string fileName) {
+  MappedFile mapped;
+  std::string buffer;
+  std::string_view bytes;
+  if (!mapped.Open(fileName) || !UnpackBoard(mapped.data, mapped.size, buffer, bytes))return;
+  // Whatever was edited so far stays recoverable from the journal of the board being replaced
+  this->FlushJournal();
+  this->recording = false;
+  bool loaded = this->LoadFile(bytes);
+  this->recording = true;
+  if (!loaded)return;
+  // The scratch board was left for this one, its journal would otherwise be replayed on every launch
+  if (this->journalFile == AUTOSAVE_JOURNAL)this->saver.Discard(this->journalFile);
+  this->boardFile = fileName;
+  this->canAppend = true;
+  this->journalFile = fileName + ".journal";
+  this->ReplayJournal(this->journalFile);
+}
+bool Board::LoadFile(std::string_view bytes) {
+  // Binary boards are read in place, the components refer to each other by index
+  if (IsBinaryBoard(bytes.data(), bytes.size())) {
+    BoardView view;
+    if (!view.Parse(bytes.data(), bytes.size()))return false;
+    this->ClearBoard();
+    std::vector<Component*> loaded(view.header->componentCount, nullptr);
+    ComponentRecord record;
+    for (uint32_t i = 0;i < view.header->componentCount;i++) {
+      const BinaryComponent& comp = view.components[i];
+      record.id.assign(view.Name(i));
+      record.type = comp.type;
+      record.x = comp.x;
+      record.y = comp.y;
+      record.inputCount = comp.inputCount;
+      record.outputCount = comp.outputCount;
+      record.state = comp.state != 0;
+      loaded[i] = this->LoadComponent(record);
+    }
+    for (uint32_t i = 0;i < view.header->connectionCount;i++) {
+      const BinaryConnection& conn = view.connections[i];
+      this->LoadConnection(loaded[conn.to], conn.toPin, loaded[conn.from], conn.fromPin);
+    }
+    if (view.header->headCount > 0) {
+      this->heads.clear();
+      for (uint32_t i = 0;i < view.header->headCount;i++)this->heads.push_back(std::string(view.String(view.heads[i])));
     }
+    this->LoadEdits(view.edits);
+    return true;
   }
-  // Load the Heads
-  if (sections[2].size() != 0) {
-    //std::cout << "Loading Heads" << std::endl;
-    std::vector<std::string> heads = splitStringByDelimiter(sections[2], ",");
-    this->heads.clear();
-    for (auto head : heads)this->heads.push_back(head);
+  // Text boards are tokenized in place, the records are views into the file bytes until the whole file has parsed
+  TextBoardParser parser(bytes);
+  std::vector<ComponentView> components;
+  std::vector<ConnectionView> connections;
+  ComponentView comp;
+  while (parser.NextComponent(comp))components.push_back(comp);
+  if (!parser.EndSection())return false; // Not a board file, leave the board alone
+  ConnectionView conn;
+  while (parser.NextConnection(conn))connections.push_back(conn);
+  if (!parser.EndSection()) {
+    return false;
+  }
+  // Loading replaces whatever is on the board
+  this->ClearBoard();
+  // Load Components First, the ids only matter while the connections are resolved
+  std::unordered_map<std::string_view, Component*> loaded;
+  loaded.reserve(components.size());
+  ComponentRecord record;
+  for (const ComponentView& view : components) {
+    record.id.assign(view.id);
+    record.type = view.type;
+    record.x = view.x;
+    record.y = view.y;
+    record.inputCount = view.inputCount;
+    record.outputCount = view.outputCount;
+    record.state = view.state;
+    Component* comp = this->LoadComponent(record);
+    if (comp)loaded[view.id] = comp;
+  }
+  // Load the Connections
+  for (const ConnectionView& conn : connections) {
+    if (conn.from.empty())continue;
+    auto toIt = loaded.find(conn.to);
+    auto fromIt = loaded.find(conn.from);
+    if (toIt == loaded.end() || fromIt == loaded.end())continue;
+    this->LoadConnection(toIt->second, conn.toPin, fromIt->second, conn.fromPin);
   }
+  // Load the Heads
+  std::string_view head;
+  if (parser.headPending)this->heads.clear();
+  while (parser.NextHead(head))this->heads.push_back(std::string(head));
+  this->LoadEdits(parser.EditSection());
+  return true;
+}
+void Board::LoadEdits(std::string_view text) {
+  // Edits appended by the delta saves since the file was last written in full
+  std::vector<EditOp> ops;
+  ReadEdits(text, ops);
+  this->ReplayEdits(ops);
+  this->savedEdits = ops.size();
 }
 void Board::SaveBoard(std::string filePath) {
-  std::string board = this->Serialize();
-  std::ofstream file(filePath);
-  if (file.is_open()) {
-    file << board;
-    std::string fileName = splitStringByDelimiter(GetFileName(filePath.c_str()), ".")[0];
-    //std::cout << "File Name: " << fileName << std::endl;
-    //std::cout << "Saved Board Successfully" << std::endl;
-    ProjectList::Insert({ fileName,filePath });
+  // Edits not journaled yet go to the old journal first, it is only discarded once the save made it to disk
+  this->FlushJournal();
+  std::string journal = filePath + ".journal";
+  std::vector<std::string> discard = { journal };
+  if (this->journalFile != journal)discard.push_back(this->journalFile);
+  // Saving over the file the board came from only appends the edits since, until they outgrow a quarter of the board
+  size_t limit = DELTA_MIN_EDITS + this->components.Size() / 4;
+  if (this->canAppend && filePath == this->boardFile && this->savedEdits + this->delta.size() <= limit) {
+    bool openSection = this->savedEdits == 0 && !UsesBinaryFormat(filePath);
+    this->savedEdits += this->delta.size();
+    this->saver.SaveDelta(filePath, std::move(this->delta), openSection, std::move(discard));
   }
   else {
-    //std::cout << "Failed to Open the File" << std::endl;
+    // Only the snapshot is taken here, encoding and writing the file happen on the saver thread.
+    // A full save also compacts the edits appended to the file so far.
+    std::string image;
+    this->Snapshot(image);
+    this->saver.SaveBoard(filePath, std::move(image), this->compressSaves, std::move(discard));
+    this->savedEdits = 0;
+    // An empty text board is an empty file, there are no sections to append to
+    this->canAppend = UsesBinaryFormat(filePath) || !this->components.Empty();
+  }
+  // The save holds every edit so far, the journal starts over once it is on disk
+  this->delta.clear();
+  this->boardFile = filePath;
+  this->journalFile = journal;
+}
+// Dragging moves a component every frame, only where it ends up matters
+static void PushEdit(std::vector<EditOp>& ops, const EditOp& op) {
+  if (op.kind == EDIT_MOVE && !ops.empty() && ops.back().kind == EDIT_MOVE && ops.back().id == op.id)ops.back() = op;
+  else ops.push_back(op);
+}
+void Board::RecordEdit(EditOp op) {
+  if (!this->recording)return;
+  PushEdit(this->edits, op);
+  PushEdit(this->delta, op);
+}
+void Board::FlushJournal() {
+  this->lastAutosave = GetTime();
+  if (this->edits.empty())return;
+  this->saver.AppendJournal(this->journalFile, std::move(this->edits));
+  this->edits.clear();
+}
+void Board::DiscardJournal() {
+  this->edits.clear();
+  this->saver.Discard(this->journalFile);
+  this->journalFile = AUTOSAVE_JOURNAL;
+}
+bool Board::ReplayJournal(const std::string& fileName) {
+  MappedFile mapped;
+  if (!mapped.Open(fileName) || mapped.size == 0)return false;
+  std::vector<EditOp> ops;
+  ReadEdits(std::string_view(mapped.data, mapped.size), ops);
+  // The replayed edits are already in the journal, but not in the board file
+  this->recording = false;
+  this->ReplayEdits(ops);
+  this->recording = true;
+  this->delta.insert(this->delta.end(), ops.begin(), ops.end());
+  return !ops.empty();
+}
+void Board::ReplayEdits(const std::vector<EditOp>& ops) {
+  std::unordered_map<std::string, Component*> byId;
+  for (Component* comp : this->components)byId.emplace(comp->id, comp);
+  auto find = [&byId](const std::string& id) {
+    auto it = byId.find(id);
+    return it == byId.end() ? nullptr : it->second;
+  };
+  for (const EditOp& op : ops) {
+    Component* comp = find(op.id);
+    if (op.kind == EDIT_INSERT) {
+      if (comp == nullptr && (comp = this->CreateComponent(op.type, op.id, { op.x,op.y })))byId[op.id] = comp;
+    }
+    else if (comp == nullptr)continue;
+    else if (op.kind == EDIT_DELETE) {
+      byId.erase(op.id);
+      this->DeleteComponent(comp);
+    }
+    else if (op.kind == EDIT_MOVE)this->MoveComponent(comp, { op.x,op.y });
+    else if (op.kind == EDIT_CONNECT) {
+      this->LoadConnection(comp, op.pin, find(op.from), op.fromPin);
+      this->heads.erase(std::remove(this->heads.begin(), this->heads.end(), op.from), this->heads.end());
+    }
+    else if (op.kind == EDIT_DISCONNECT && op.pin >= 0 && op.pin < (int)comp->inputs->size())this->DeleteConnection(comp, op.pin);
+    else if (op.kind == EDIT_STATE)comp->state = op.type;
   }
-  file.close();
 }
 void Board::ClearBoard() {
-  for (auto& it : this->components)delete it.second;
-  this->components.clear();
+  // The strings and maps inside the components still need their destructors, the memory itself goes back in one shot
+  for (Component* comp : this->components)comp->~Component();
+  this->components.Clear();
+  this->netNodes.Clear();
+  this->grid.Clear();
+  this->wireGrid.Clear();
+  this->moved.clear();
+  this->wiresDirty = true;
+  this->arena.Reset();
   this->heads.clear();
   this->activeComponent = nullptr;
   this->inputPin = nullptr;
   this->outputPin = nullptr;
+  this->netlistDirty = true;
+  this->boardFile.clear();
+  this->delta.clear();
+  this->savedEdits = 0;
+  this->canAppend = false;
 }
 
 
@@ -713,7 +1044,8 @@ void DropDown::SetComponent(Component* comp) {
   this->comp = comp;
   this->active = true;
   this->dimension = { 150,(float)30 * (comp->inputCount + 2) };
-  float posX = comp->position.x + comp->size.x, posY = comp->position.y + comp->size.y;
+  Vector2 corner = GetWorldToScreen2D({ comp->position.x + comp->size.x,comp->position.y + comp->size.y }, this->parent->camera);
+  float posX = corner.x, posY = corner.y;
   if (posX < parent->GetCoordinates({ 0,0 }).x)posX = parent->GetCoordinates({ 0,0 }).x;
   else if (posX + this->dimension.x > this->parent->dimension.x + this->parent->dimension.width)posX = this->parent->dimension.x + this->parent->dimension.width - this->dimension.x;
 
@@ -735,7 +1067,6 @@ void DropDown::Draw() {
       this->active = false;
     }
     if (GuiButton(this->GetRectangle({ 0,30,150,30 }), "Delete")) {
-      //std::cout << "Delete: " << this->comp->id << std::endl;
       this->parent->DeleteComponent(this->comp);
       this->comp = nullptr;
       this->active = false;
@@ -746,7 +1077,6 @@ void DropDown::Draw() {
         std::string label = "Disconnect Pin " + std::to_string(i);
         if ((*this->comp->inputs)[i].child != nullptr) {
           if (GuiButton(this->GetRectangle({ 0,(float)y,150,30 }), label.c_str())) {
-            //std::cout << "Disconnect Pin " << i << std::endl;
             this->parent->DeleteConnection(this->comp, i);
           }
         }
@@ -765,22 +1095,38 @@ void DropDown::Draw() {
 
 
 
+// Event Dispatcher Class
+void EventDispatcher::Register(ComponentEvent event, std::function<void(Component*, void*)> handler) {
+  if (handler != nullptr)this->handlers[event].push_back(handler);
+}
+void EventDispatcher::Emit(ComponentEvent event, Component* comp, void* data) {
+  for (auto& handler : this->handlers[event])handler(comp, data);
+}
+
+
+
 // Component Class
-Component::Component(std::string id, Vector2 position) {
+Component::Component(Arena* arena, std::string id, Vector2 position) {
+  this->arena = arena;
   this->id = id;
   this->position = position;
   this->pinSize = 5;
   this->size = { 50,50 };
-  this->inputs = new std::vector<InputPin>();
-  this->outputs = new std::vector<OutputPin>();
+  this->inputs = arena->New<InputPinList>(ArenaAllocator<InputPin>(arena));
+  this->outputs = arena->New<OutputPinList>(ArenaAllocator<OutputPin>(arena));
 
-  this->eventHandler["select"] = [](void*) {};
-  this->eventHandler["inputPin"] = [](void*) {};
-  this->eventHandler["outputPin"] = [](void*) {};
   this->state = false;
+  this->netNode = -1;
+  this->handle = INVALID_SLOT;
+  this->gridStamp = 0;
+  this->pinsDirty = false;
 
 }
-Component::~Component() {}
+Component::~Component() {
+  for (auto& output : *this->outputs)this->arena->Delete(output.parent);
+  this->arena->Delete(this->inputs);
+  this->arena->Delete(this->outputs);
+}
 void Component::Draw() {
   DrawRectangleV(this->position, this->size, BLACK);
   for (int i = 0;i < this->inputCount;i++) {
@@ -794,31 +1140,33 @@ void Component::Draw() {
   }
 
 }
-void Component::Update() {
-  if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), { this->position.x,this->position.y,this->size.x,this->size.y })) {
-    this->eventHandler["select"](nullptr);
+Rectangle Component::GetBounds() {
+  // Pins sit on the left and right edges, half of their circle sticks out
+  return { this->position.x - this->pinSize,this->position.y - this->pinSize,this->size.x + 2 * this->pinSize,this->size.y + 2 * this->pinSize };
+}
+void Component::HandleInput(EventDispatcher& events, Vector2 mouse) {
+  if (CheckCollisionPointRec(mouse, { this->position.x,this->position.y,this->size.x,this->size.y })) {
+    events.Emit(EVENT_SELECT, this, nullptr);
   }
-
-  if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-    for (int i = 0;i < this->inputCount;i++) {
-      InputPin* pin = &(*this->inputs)[i];
-      if (CheckCollisionPointCircle(GetMousePosition(), (*pin).position, this->pinSize)) {
-        this->eventHandler["inputPin"](pin);
-        //std::cout << (*pin).position.x << ", " << (*pin).position.y << std::endl;
-        break;
-      }
+  for (int i = 0;i < this->inputCount;i++) {
+    InputPin* pin = &(*this->inputs)[i];
+    if (CheckCollisionPointCircle(mouse, (*pin).position, this->pinSize)) {
+      events.Emit(EVENT_INPUT_PIN, this, pin);
+      break;
     }
-    for (int i = 0;i < this->outputCount;i++) {
-      OutputPin* pin = &(*this->outputs)[i];
-      if (CheckCollisionPointCircle(GetMousePosition(), (*pin).position, this->pinSize)) {
-        this->eventHandler["outputPin"](pin);
-        break;
-      }
+  }
+  for (int i = 0;i < this->outputCount;i++) {
+    OutputPin* pin = &(*this->outputs)[i];
+    if (CheckCollisionPointCircle(mouse, (*pin).position, this->pinSize)) {
+      events.Emit(EVENT_OUTPUT_PIN, this, pin);
+      break;
     }
   }
-
-
-
+}
+Color Component::GetLodColor() {
+  return DARKGRAY;
+}
+void Component::LayoutPins() {
   int delta = 0;
   if (this->inputCount == 1) {
     (*this->inputs)[0].position = { this->position.x,this->position.y + this->size.y / 2 };
@@ -846,16 +1194,13 @@ void Component::Update() {
 
 
 }
-void Component::Register(std::string event, std::function<void(void*)> handler) {
-  this->eventHandler[event] = handler != nullptr ? handler : [](void*) {};
-}
 
 
 
 // Gate Class
-Gate::Gate(GateType type, Texture texture, std::string id, Vector2 position) :Component(id, position) {
+Gate::Gate(Arena* arena, GateType type, Sprite sprite, std::string id, Vector2 position) :Component(arena, id, position) {
   this->type = type;
-  this->texture = texture;
+  this->sprite = sprite;
   this->inputCount = 2;
   this->outputCount = 1;
   int delta = 10;
@@ -873,93 +1218,52 @@ Gate::Gate(GateType type, Texture texture, std::string id, Vector2 position) :Co
   }
 
   if (this->outputCount == 1) {
-    this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,this->position.y + this->size.y / 2},0, new std::vector<InputPin*>(), this });
+    this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,this->position.y + this->size.y / 2},0, this->arena->New<FanoutList>(ArenaAllocator<InputPin*>(this->arena)), this });
   }
   else {
     double spacing = this->size.y / (this->inputCount - 1.0);
     for (int i = 0; i < this->inputCount; i++) {
-      this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,static_cast<float>(this->position.y + (i * spacing)) + delta},i, new std::vector<InputPin*>(), this });
+      this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,static_cast<float>(this->position.y + (i * spacing)) + delta},i, this->arena->New<FanoutList>(ArenaAllocator<InputPin*>(this->arena)), this });
     }
   }
 
 }
 Gate::~Gate() {}
-bool Gate::GetState(std::map<Component*, bool> visited) {
-  if (visited[this])return this->state;
-  // If the gate is NOT gate there are only one input pin thus if connected invert and return else return false
-  if (this->type == NOT) {
-    visited[this] = true;
-    this->state = (*this->inputs)[0].child ? !(*this->inputs)[0].child->self->GetState(visited) : false;
-    visited[this] = false;
-    return this->state;
-  }
-  // Else calculate the state by the states of the child components
-  bool temp_state = (this->type == OR || this->type == XOR || this->type == NOR) ? false : true;
-  for (auto& input : (*this->inputs)) {
-    visited[this] = true;
-    bool val = input.child ? input.child->self->GetState(visited) : false; // TODO:: You Are Here
-    switch (this->type) {
-    case AND:
-    case NAND:
-      temp_state = temp_state & val;
-      break;
-    case OR:
-    case NOR:
-      temp_state = temp_state | val;
-      break;
-    case XOR:
-      temp_state = temp_state ^ val;
-      break;
-    default:
-      temp_state = false;
-    }
-
-    visited[this] = false;
-  }
-
-  if (this->type == NAND || this->type == NOR) {
-    this->state = !temp_state; // Invert the state for the NAND and NOR gates
-  }
-  else {
-    this->state = temp_state; // Set the State
-  }
-  return this->state; // Return the State
-}
 void Gate::Draw() {
-  DrawTexture(this->texture, this->position.x, this->position.y, WHITE);
+  DrawSprite(this->sprite, this->position, WHITE);
 
 }
 
 
 
 // Switch Class
-Switch::Switch(std::string id, Texture on, Texture off, Vector2 position) :Component(id, position) {
+Switch::Switch(Arena* arena, std::string id, Sprite on, Sprite off, Vector2 position) :Component(arena, id, position) {
   this->on = on;
   this->off = off;
   this->inputCount = 0;
   this->outputCount = 1;
-  this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,this->position.y + this->size.y / 2},0, new std::vector<InputPin*>(), this });
+  this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,this->position.y + this->size.y / 2},0, this->arena->New<FanoutList>(ArenaAllocator<InputPin*>(this->arena)), this });
 }
 Switch::~Switch() {}
-bool Switch::GetState(std::map<Component*, bool> visited) {
-  return this->state;
-}
 void Switch::ToggleState() {
   this->state = !this->state;
 }
+Color Switch::GetLodColor() {
+  return this->state ? Color{ 255,29,13,255 } : Color{ 110,168,74,255 };
+}
 void Switch::Draw() {
   if (this->state) {
-    DrawTexture(this->on, this->position.x, this->position.y, WHITE);
+    DrawSprite(this->on, this->position, WHITE);
   }
   else {
-    DrawTexture(this->off, this->position.x, this->position.y, WHITE);
+    DrawSprite(this->off, this->position, WHITE);
   }
 }
 
 
 
 // Bulb Class
-Bulb::Bulb(std::string id, Texture on, Texture off, Vector2 position) :Component(id, position) {
+Bulb::Bulb(Arena* arena, std::string id, Sprite on, Sprite off, Vector2 position) :Component(arena, id, position) {
   this->on = on;
   this->off = off;
   this->inputCount = 1;
@@ -967,39 +1271,29 @@ Bulb::Bulb(std::string id, Texture on, Texture off, Vector2 position) :Component
   this->inputs->push_back(InputPin{ {this->position.x,this->position.y + this->size.y / 2},0,nullptr,this });
 }
 Bulb::~Bulb() {}
-bool Bulb::GetState(std::map<Component*, bool> visited) {
-  this->state = (*this->inputs)[0].child ? (*this->inputs)[0].child->self->GetState(visited) : false;
-  return this->state;
+Color Bulb::GetLodColor() {
+  return this->state ? Color{ 253,249,0,255 } : GRAY;
 }
 void Bulb::Draw() {
   if (this->state) {
-    DrawTexture(this->on, this->position.x, this->position.y, WHITE);
+    DrawSprite(this->on, this->position, WHITE);
   }
   else {
-    DrawTexture(this->off, this->position.x, this->position.y, WHITE);
+    DrawSprite(this->off, this->position, WHITE);
   }
 }
 
 
-Clock::Clock(std::string id, std::map<int, Texture> texture, Vector2 position) : Component(id, position) {
+Clock::Clock(Arena* arena, std::string id, std::map<int, Sprite> texture, Vector2 position) : Component(arena, id, position) {
   this->inputCount = 0;
   this->outputCount = 1;
-  this->lastToggleTime = 0.0;
-  this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,this->position.y + this->size.y / 2},0, new std::vector<InputPin*>(), this });
+  this->outputs->push_back(OutputPin{ {this->position.x + this->size.x,this->position.y + this->size.y / 2},0, this->arena->New<FanoutList>(ArenaAllocator<InputPin*>(this->arena)), this });
   this->hertz = 1;
-  this->interval = 1.0 / this->hertz;
   for (auto it : texture) {
     this->texture[it.first] = it.second;
   }
 }
 Clock::~Clock() {}
-bool Clock::GetState(std::map<Component*, bool> visited) {
-  if (GetTime() - this->lastToggleTime >= this->interval) {
-    this->state = !this->state;
-    this->lastToggleTime = GetTime();
-  }
-  return this->state;
-}
 void Clock::ToggleState() {
   if (this->hertz == 1) {
     this->hertz = 5;
@@ -1019,10 +1313,12 @@ void Clock::ToggleState() {
   else {
     this->hertz = 1;
   }
-  this->interval = 1.0 / this->hertz;
+}
+Color Clock::GetLodColor() {
+  return this->state ? Color{ 255,29,13,255 } : Color{ 110,168,74,255 };
 }
 void Clock::Draw() {
-  DrawTexture(this->texture[this->hertz], this->position.x, this->position.y, WHITE);
+  DrawSprite(this->texture[this->hertz], this->position, WHITE);
 }
 
 
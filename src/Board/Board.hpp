@@ -4,90 +4,135 @@
 #include <map>
 #include <functional>
 #include <vector>
+#include "../Netlist/Netlist.hpp"
+#include "../Netlist/BatchEvaluator.hpp"
+#include "../Netlist/SimulationThread.hpp"
+#include "../Netlist/ClockScheduler.hpp"
+#include "SlotMap.hpp"
+#include "Arena.hpp"
+#include "SpatialGrid.hpp"
+#include "Atlas.hpp"
+#include "../Serializer/Serializer.hpp"
+#include "../Serializer/BoardSaver.hpp"
+#include "../Serializer/MappedFile.hpp"
+#include "../Serializer/Compression.hpp"
 
 class Component;
+struct InputPin;
 struct OutputPin;
+// Pin and fan-out storage lives in the board's Arena next to the component
+typedef std::vector<InputPin*, ArenaAllocator<InputPin*>> FanoutList;
+typedef std::vector<InputPin, ArenaAllocator<InputPin>> InputPinList;
+typedef std::vector<OutputPin, ArenaAllocator<OutputPin>> OutputPinList;
 typedef struct InputPin {
   Vector2 position;
   int pinNo;
   OutputPin* child;
   Component* self;
+  Vector2 wire[4]; // Cached Manhattan route to the child pin, refreshed when either end moves
+  Rectangle gridBounds;   // Bounds of the route in Board::wireGrid
+  unsigned int gridStamp; // Last SpatialGrid query that reported the connection
+  int wireIndex;          // Connection number in Board::wireVertices, valid while the batch is not dirty
 }InputPins;
 
 typedef struct OutputPin {
   Vector2 position;
   int pinNo;
-  std::vector<InputPin*>* parent;
+  FanoutList* parent;
   Component* self;
 }OutputPin;
 
+// Input events raised by the components, the board keeps one handler table per kind instead of a map per component
+typedef enum ComponentEvent {
+  EVENT_SELECT,     // Left click on the body of a component
+  EVENT_INPUT_PIN,  // Left click on an input pin, data is the InputPin*
+  EVENT_OUTPUT_PIN, // Left click on an output pin, data is the OutputPin*
+  EVENT_COUNT
+}ComponentEvent;
 
-typedef enum GateType {
-  AND, OR, NOT, NOR, NAND, XOR
-}GateType;
+class EventDispatcher {
+public:
+  std::vector<std::function<void(Component*, void*)>> handlers[EVENT_COUNT];
+  void Register(ComponentEvent event, std::function<void(Component*, void*)> handler);
+  void Emit(ComponentEvent event, Component* comp, void* data);
+};
 
 class Component {
 public:
-  std::string id;
+  std::string id;    // Label used by the save files, lookups go through the handle
+  SlotHandle handle; // Slot of the component in Board::components
   Vector2 position;
   Vector2 size;
   float pinSize;
-  std::map<std::string, std::function<void(void*)>> eventHandler;
   int inputCount;
   int outputCount;
-  std::vector<InputPin>* inputs;
-  std::vector<OutputPin>* outputs;
+  InputPinList* inputs;
+  OutputPinList* outputs;
   bool state;
-  Texture2D texture;
-  Component(std::string id, Vector2 position);
-  ~Component();
+  int netNode; // Dense index of the component, shared by Board::components and Board::netNodes
+  bool pinsDirty;         // Set when the component moved, the pins and wires are laid out again on the next update
+  Rectangle gridBounds;   // Bounds the component is filed under in Board::grid
+  unsigned int gridStamp; // Last SpatialGrid query that reported the component
+  Sprite sprite;
+  Arena* arena; // Owner of the component and its pins
+  Component(Arena* arena, std::string id, Vector2 position);
+  virtual ~Component();
   void virtual Draw();
-  void Update();
-  void Register(std::string event, std::function<void(void*)> handler);
-  bool virtual GetState(std::map<Component*, bool> visited) = 0; // NOTE: Here the map is inserted lately and must be removed if any problem is caused
+  Color virtual GetLodColor();
+  Rectangle GetBounds();
+  void LayoutPins();
+  void HandleInput(EventDispatcher& events, Vector2 mouse);
 };
 
 class Gate :public Component {
 public:
   GateType type;
-  Gate(GateType type, Texture texture, std::string id, Vector2 position);
+  Gate(Arena* arena, GateType type, Sprite sprite, std::string id, Vector2 position);
   ~Gate();
-  bool GetState(std::map<Component*, bool> visited);
   void Draw() override;
 };
 
 class Switch :public Component {
 public:
-  Texture on, off;
-  Switch(std::string id, Texture on, Texture off, Vector2 position);
+  Sprite on, off;
+  Switch(Arena* arena, std::string id, Sprite on, Sprite off, Vector2 position);
   ~Switch();
-  bool GetState(std::map<Component*, bool> visited);
   void ToggleState();
   void Draw() override;
+  Color GetLodColor() override;
 };
 
 class Clock :public Component {
 public:
-  std::map<int, Texture> texture;
-  int hertz;
-  double lastToggleTime;
-  double interval;
-  Clock(std::string id, std::map<int, Texture> texture, Vector2 position);
+  std::map<int, Sprite> texture;
+  int hertz; // Toggles per second of virtual time, the edges come from the board's ClockScheduler
+  Clock(Arena* arena, std::string id, std::map<int, Sprite> texture, Vector2 position);
   ~Clock();
-  bool GetState(std::map<Component*, bool> visited);
   void ToggleState();
   void Draw() override;
+  Color GetLodColor() override;
 };
 
 class Bulb :public Component {
 public:
-  Texture on, off;
-  Bulb(std::string id, Texture on, Texture off, Vector2 position);
+  Sprite on, off;
+  Bulb(Arena* arena, std::string id, Sprite on, Sprite off, Vector2 position);
   ~Bulb();
-  bool GetState(std::map<Component*, bool> visited);
   void Draw() override;
+  Color GetLodColor() override;
 };
 
+// Zoom levels below which the board switches to cheaper drawing
+typedef struct LevelOfDetail {
+  float spriteZoom; // Components become flat rectangles in their state colour
+  float wireZoom;   // Wires become single thin lines between their pins
+}LevelOfDetail;
+
+typedef enum SimulationMode {
+  SIM_LEVELIZED,   // Evaluate every gate once per tick in level order
+  SIM_EVENT_DRIVEN // Only re-evaluate the fan-out of nets that changed
+}SimulationMode;
+
 // Forward declaration of Board
 class Board;
 
@@ -108,30 +153,98 @@ public:
 class Board {
 public:
   Rectangle dimension;
-  std::map<std::string, Component*> components;
-  std::map<std::string, Texture> textures;
+  Arena arena; // Declared before everything that points into it
+  SlotMap<Component*> components;
+  EventDispatcher events;
+  SpatialGrid<Component> grid;
+  SpatialGrid<InputPin> wireGrid; // Every connection filed under its input pin
+  std::vector<Component*> hits; // Scratch list of the components under the mouse
+  std::vector<Component*> visible; // Scratch list of the components inside the view
+  Camera2D camera;                 // View of the unbounded canvas inside this->dimension
+  static constexpr float MIN_ZOOM = 0.05f;
+  static constexpr float MAX_ZOOM = 4.0f;
+  LevelOfDetail lod;
+  std::vector<Component*> moved; // Components whose pin geometry is stale
+  static const int WIRE_VERTICES = 18;  // Three segments of two triangles per connection
+  std::vector<Vector2> wireVertices;    // Triangles of every connection, rebuilt when connections come and go
+  std::vector<InputPin*> visibleWires;  // Scratch list of the connections inside the view
+  bool wiresDirty;
+  TextureAtlas atlas;
   std::vector<std::string> heads;
   Component* activeComponent;
   InputPin* inputPin;
   OutputPin* outputPin;
   bool simulationRunning;
+  SimulationMode simulationMode;
+  Netlist netlist;
+  NetDescription netNodes;       // Flat description of the board kept up to date on every edit, the netlist is compiled from it
+  std::vector<Component*> nodes; // Component of every node of the compiled netlist
+  bool netlistDirty;             // Set when an edit could not be patched into the netlist, it is rebuilt before the next tick
+  bool netlistPatched;           // Set when an edit was patched into the netlist, the simulation thread needs the new one
+  ClockScheduler clocks;
+  SimTime tickPeriod;            // Virtual time covered by one Simulate call
+  bool threadedSimulation;       // Run the simulation on its own thread instead of once per frame
+  SimulationThread simThread;
+  unsigned int simGeneration;    // Generation of the netlist last handed to the simulation thread
+  NetSnapshot snapshot;
+  BoardSaver saver;              // Writes saves and the journal off the UI thread
+  std::vector<EditOp> edits;     // Edits not yet appended to the journal
+  bool recording;                // Off while loading and replaying, those are not new edits
+  std::string journalFile;       // Append only log of the edits since the board was last saved or loaded
+  std::string boardFile;         // File the board was last loaded from or saved to
+  std::vector<EditOp> delta;     // Edits not in boardFile yet
+  size_t savedEdits;             // Edits appended to boardFile since it was last written in full
+  bool canAppend;                // boardFile holds what the board was before delta, saving to it only appends delta
+  bool compressSaves;            // Full saves are written compressed, loading tells them apart by their header
+  double lastAutosave;
+  static constexpr double AUTOSAVE_INTERVAL = 5.0;
+  static const size_t DELTA_MIN_EDITS = 64; // Appended edits allowed on top of a quarter of the components before a full save
+  static constexpr const char* AUTOSAVE_JOURNAL = "autosave.journal"; // Journal of a board without a file yet
   DropDown* dropDown;
   Board(Rectangle dimesion);
   ~Board();
   void Draw();
   void Update();
   Vector2 GetCoordinates(Vector2 coordinate);
-  void InsertGate(std::string id, GateType type, Texture texture);
-  void InsertSwitch(std::string id, Texture on, Texture off);
-  void InsertBulb(std::string id, Texture on, Texture off);
-  void InsertClock(std::string id);
+  Rectangle GetViewport();
+  Rectangle GetVisibleArea();
+  Vector2 ScreenToWorld(Vector2 point);
+  void UpdateCamera();
+  SlotHandle AddComponent(Component* comp);
+  void FreeComponent(Component* comp);
+  void MoveComponent(Component* comp, Vector2 position);
+  void MarkMoved(Component* comp);
+  void UpdateGeometry();
+  void RerouteWire(InputPin& input);
+  Component* GetComponent(SlotHandle handle);
+  SlotHandle InsertGate(std::string id, GateType type, Sprite sprite);
+  SlotHandle InsertSwitch(std::string id, Sprite on, Sprite off);
+  SlotHandle InsertBulb(std::string id, Sprite on, Sprite off);
+  SlotHandle InsertClock(std::string id);
+  void ConnectPins(InputPin* input, OutputPin* output);
   void DeleteComponent(Component* comp);
   void DeleteConnection(Component* comp, int pin);
-  void DrawConnection(Component* comp);
+  void BuildWires();
+  void DrawWires(Rectangle area);
+  void CompileNetlist();
+  void PatchNetlist(int node, int pin);
+  void SetSimulationMode(SimulationMode mode);
   void Simulate();
+  void SyncSimulationThread();
+  bool SweepTruthTable(TruthTable& table);
   void PrintBoard(); // Just to Debug the Program
-  std::string Serialize();
-  void Deserialize(std::string fileName);
-  void SaveBoard(std::string fileName);
+  void Snapshot(std::string& image);
+  Component* CreateComponent(int code, const std::string& id, Vector2 position);
+  Component* LoadComponent(const ComponentRecord& record);
+  void LoadConnection(Component* to, int toPin, Component* from, int fromPin);
+  bool LoadFile(std::string_view bytes); // Board file bytes, already unpacked when compressed
+  void LoadEdits(std::string_view text);
+  void Deserialize(std::string fileName); // Text or binary, told apart by the file header
+  void SaveBoard(std::string fileName);   // Returns right away, the file is written in the background
+  void RecordEdit(EditOp op);
+  void FlushJournal();
+  void DiscardJournal();
+  bool ReplayJournal(const std::string& fileName);
+  void ReplayEdits(const std::vector<EditOp>& ops);
   void ClearBoard();
 };
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stable reference into a SlotMap, stays invalid forever once its value is erased
+typedef struct SlotHandle {
+  uint32_t index;
+  uint32_t generation;
+}SlotHandle;
+
+static const SlotHandle INVALID_SLOT = { ~0u, 0 };
+
+// Generational slot map: values are kept densely packed for iteration,
+// handles go through a slot table for O(1) lookup and O(1) erase (the last value is moved into the hole)
+template <typename T>
+class SlotMap {
+public:
+  std::vector<T> values;              // Dense storage, iteration order
+  std::vector<uint32_t> valueSlot;    // Slot owning every dense value
+  std::vector<uint32_t> slotIndex;    // Dense index of a used slot, next free slot of a free one
+  std::vector<uint32_t> slotGeneration;
+  uint32_t freeHead;
+
+  SlotMap() {
+    this->freeHead = ~0u;
+  }
+  SlotHandle Insert(const T& value) {
+    uint32_t slot;
+    if (this->freeHead != ~0u) {
+      slot = this->freeHead;
+      this->freeHead = this->slotIndex[slot];
+    }
+    else {
+      slot = (uint32_t)this->slotIndex.size();
+      this->slotIndex.push_back(0);
+      this->slotGeneration.push_back(1);
+    }
+    this->slotIndex[slot] = (uint32_t)this->values.size();
+    this->values.push_back(value);
+    this->valueSlot.push_back(slot);
+    return SlotHandle{ slot, this->slotGeneration[slot] };
+  }
+  bool Contains(SlotHandle handle) const {
+    return handle.index < this->slotGeneration.size() && this->slotGeneration[handle.index] == handle.generation;
+  }
+  T* Get(SlotHandle handle) {
+    if (!this->Contains(handle))return nullptr;
+    return &this->values[this->slotIndex[handle.index]];
+  }
+  bool Erase(SlotHandle handle) {
+    if (!this->Contains(handle))return false;
+    uint32_t dense = this->slotIndex[handle.index];
+    uint32_t last = (uint32_t)this->values.size() - 1;
+    if (dense != last) {
+      this->values[dense] = this->values[last];
+      this->valueSlot[dense] = this->valueSlot[last];
+      this->slotIndex[this->valueSlot[dense]] = dense;
+    }
+    this->values.pop_back();
+    this->valueSlot.pop_back();
+    // Bumping the generation invalidates every handle still pointing at this slot
+    this->slotGeneration[handle.index]++;
+    this->slotIndex[handle.index] = this->freeHead;
+    this->freeHead = handle.index;
+    return true;
+  }
+  void Clear() {
+    for (uint32_t slot : this->valueSlot) {
+      this->slotGeneration[slot]++;
+      this->slotIndex[slot] = this->freeHead;
+      this->freeHead = slot;
+    }
+    this->values.clear();
+    this->valueSlot.clear();
+  }
+  size_t Size() const {
+    return this->values.size();
+  }
+  bool Empty() const {
+    return this->values.empty();
+  }
+  typename std::vector<T>::iterator begin() {
+    return this->values.begin();
+  }
+  typename std::vector<T>::iterator end() {
+    return this->values.end();
+  }
+  typename std::vector<T>::const_iterator begin() const {
+    return this->values.begin();
+  }
+  typename std::vector<T>::const_iterator end() const {
+    return this->values.end();
+  }
+};
@@ -0,0 +1,100 @@
+#include "SpatialGrid.hpp"
+#include "Board.hpp"
+#include <algorithm>
+#include <cmath>
+
+template <typename T>
+SpatialGrid<T>::SpatialGrid(float cellSize) {
+  this->cellSize = cellSize;
+  this->queryStamp = 0;
+}
+template <typename T>
+int64_t SpatialGrid<T>::CellKey(int cx, int cy) const {
+  // Shifted as unsigned, cells left of or above the origin have negative coordinates
+  return (int64_t)(((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy);
+}
+template <typename T>
+void SpatialGrid<T>::CellRange(Rectangle bounds, int& x0, int& y0, int& x1, int& y1) const {
+  x0 = (int)std::floor(bounds.x / this->cellSize);
+  y0 = (int)std::floor(bounds.y / this->cellSize);
+  x1 = (int)std::floor((bounds.x + bounds.width) / this->cellSize);
+  y1 = (int)std::floor((bounds.y + bounds.height) / this->cellSize);
+}
+template <typename T>
+void SpatialGrid<T>::Insert(T* item, Rectangle bounds) {
+  item->gridBounds = bounds;
+  int x0, y0, x1, y1;
+  this->CellRange(bounds, x0, y0, x1, y1);
+  for (int cy = y0;cy <= y1;cy++) {
+    for (int cx = x0;cx <= x1;cx++)this->cells[this->CellKey(cx, cy)].push_back(item);
+  }
+}
+template <typename T>
+void SpatialGrid<T>::Remove(T* item) {
+  int x0, y0, x1, y1;
+  this->CellRange(item->gridBounds, x0, y0, x1, y1);
+  for (int cy = y0;cy <= y1;cy++) {
+    for (int cx = x0;cx <= x1;cx++) {
+      auto it = this->cells.find(this->CellKey(cx, cy));
+      if (it == this->cells.end())continue;
+      std::vector<T*>& cell = it->second;
+      cell.erase(std::remove(cell.begin(), cell.end(), item), cell.end());
+      if (cell.empty())this->cells.erase(it);
+    }
+  }
+}
+template <typename T>
+void SpatialGrid<T>::Move(T* item, Rectangle bounds) {
+  int ox0, oy0, ox1, oy1, nx0, ny0, nx1, ny1;
+  this->CellRange(item->gridBounds, ox0, oy0, ox1, oy1);
+  this->CellRange(bounds, nx0, ny0, nx1, ny1);
+  // Dragging mostly stays inside the same cells, only the bounds need updating then
+  if (ox0 == nx0 && oy0 == ny0 && ox1 == nx1 && oy1 == ny1) {
+    item->gridBounds = bounds;
+    return;
+  }
+  this->Remove(item);
+  this->Insert(item, bounds);
+}
+template <typename T>
+void SpatialGrid<T>::QueryPoint(Vector2 point, std::vector<T*>& result) const {
+  result.clear();
+  auto it = this->cells.find(this->CellKey((int)std::floor(point.x / this->cellSize), (int)std::floor(point.y / this->cellSize)));
+  if (it == this->cells.end())return;
+  for (T* item : it->second) {
+    if (CheckCollisionPointRec(point, item->gridBounds))result.push_back(item);
+  }
+}
+template <typename T>
+void SpatialGrid<T>::QueryRect(Rectangle area, std::vector<T*>& result) {
+  result.clear();
+  if (++this->queryStamp == 0)this->queryStamp = 1;
+  int x0, y0, x1, y1;
+  this->CellRange(area, x0, y0, x1, y1);
+  // Areas spanning more cells than are occupied are cheaper to answer by walking the occupied ones
+  if ((double)(x1 - x0 + 1) * (y1 - y0 + 1) > (double)this->cells.size()) {
+    for (auto& it : this->cells)this->Collect(it.second, area, result);
+    return;
+  }
+  for (int cy = y0;cy <= y1;cy++) {
+    for (int cx = x0;cx <= x1;cx++) {
+      auto it = this->cells.find(this->CellKey(cx, cy));
+      if (it != this->cells.end())this->Collect(it->second, area, result);
+    }
+  }
+}
+template <typename T>
+void SpatialGrid<T>::Collect(const std::vector<T*>& cell, Rectangle area, std::vector<T*>& result) {
+  for (T* item : cell) {
+    if (item->gridStamp == this->queryStamp || !CheckCollisionRecs(area, item->gridBounds))continue;
+    item->gridStamp = this->queryStamp;
+    result.push_back(item);
+  }
+}
+template <typename T>
+void SpatialGrid<T>::Clear() {
+  this->cells.clear();
+}
+
+template class SpatialGrid<Component>;
+template class SpatialGrid<InputPin>;
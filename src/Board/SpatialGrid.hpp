@@ -0,0 +1,26 @@
+#pragma once
+#include <raylib.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the bounds of board items, a click or a visible area only looks at the cells it touches
+// instead of every item on the board. T keeps the bounds it is filed under in gridBounds and the last query that
+// reported it in gridStamp, the board files components (pins included) and wires
+template <typename T>
+class SpatialGrid {
+public:
+  float cellSize;
+  std::unordered_map<int64_t, std::vector<T*>> cells;
+  unsigned int queryStamp; // Items reached through several cells are reported once per query
+  SpatialGrid(float cellSize = 128.0f);
+  int64_t CellKey(int cx, int cy) const;
+  void CellRange(Rectangle bounds, int& x0, int& y0, int& x1, int& y1) const;
+  void Insert(T* item, Rectangle bounds);
+  void Remove(T* item);
+  void Move(T* item, Rectangle bounds);
+  void QueryPoint(Vector2 point, std::vector<T*>& result) const;
+  void QueryRect(Rectangle area, std::vector<T*>& result);
+  void Collect(const std::vector<T*>& cell, Rectangle area, std::vector<T*>& result);
+  void Clear();
+};
@@ -7,9 +7,9 @@ std::string Dialog::file = "";
 
 void Dialog::RequestOpenDialog() {
   //std::cout << "Success Fully called the function\n";
-  const char* filters[] = { "*.txt" };
+  const char* filters[] = { "*.gwb", "*.txt" };
   const char* filepath = tinyfd_openFileDialog(
-    "Open a File", "", 1, filters, "Text", 0);
+    "Open a File", "", 2, filters, "Board Files", 0);
   if (filepath) {
     file = filepath;
     success = true;
@@ -21,7 +21,7 @@ void Dialog::RequestOpenDialog() {
   //std::cout << "Opened File\n";
 }
 void Dialog::RequestSaveDialog() {
-  const char* filepath = tinyfd_saveFileDialog("Save File", "output.txt", 0, NULL, NULL);
+  const char* filepath = tinyfd_saveFileDialog("Save File", "output.gwb", 0, NULL, NULL);
   if (filepath) {
     file = filepath;
     success = true;
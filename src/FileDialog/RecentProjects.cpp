@@ -26,6 +26,10 @@ std::vector<Project> ProjectList::projects;
 const std::string ProjectList::project_cache = "C:/Binary/Coding/Projects/GateSimulator/project_cache.txt";
 
 void ProjectList::Insert(Project project) {
+  // Saving a project again must not rewrite the cache
+  for (const Project& known : ProjectList::projects) {
+    if (known.projectFile == project.projectFile)return;
+  }
   ProjectList::projects.push_back(project);
   SaveProject();
   // for (auto project : projects) {
@@ -0,0 +1,109 @@
+#include "BatchEvaluator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lane patterns of the six lowest inputs, lane i of input k is bit k of i
+static const uint64_t lanePattern[6] = {
+  0xAAAAAAAAAAAAAAAAull,
+  0xCCCCCCCCCCCCCCCCull,
+  0xF0F0F0F0F0F0F0F0ull,
+  0xFF00FF00FF00FF00ull,
+  0xFFFF0000FFFF0000ull,
+  0xFFFFFFFF00000000ull
+};
+
+BatchEvaluator::BatchEvaluator(const Netlist* netlist, int words, const GateKernels* kernels) {
+  this->netlist = netlist;
+  this->words = words > 0 ? words : 1;
+  this->kernels = kernels ? kernels : &GetKernels();
+  this->Reset();
+}
+void BatchEvaluator::Reset() {
+  this->values.assign(this->netlist->values.size() * this->words, 0);
+}
+uint64_t* BatchEvaluator::GetSource(int node) {
+  return this->values.data() + (size_t)this->netlist->nodeOutput[node] * this->words;
+}
+void BatchEvaluator::Evaluate() {
+  const std::vector<int>& fanin = this->netlist->fanin;
+  const GateKernels& k = *this->kernels;
+  size_t w = this->words;
+  uint64_t* base = this->values.data();
+  for (const NetOp& op : this->netlist->ops) {
+    if (op.kind != NODE_GATE)continue;
+    const int* in = fanin.data() + op.faninBegin;
+    uint64_t* dst = base + op.output * w;
+    if (op.type == NOT) {
+      // An unconnected NOT gate stays low, just like in the single lane netlist
+      if (op.faninCount > 0)k.invert(dst, base + in[0] * w, w);
+      else k.accumulate(AND, dst, base, w);
+      continue;
+    }
+    // Gates on the board always have two fan-ins, the rest is only there to match Netlist::EvaluateGate
+    if (op.faninCount == 2) {
+      k.gate2(op.type, dst, base + in[0] * w, base + in[1] * w, w);
+      continue;
+    }
+    if (op.faninCount == 0) {
+      // Nothing to fold, AND and NOR come out high and the rest low
+      if (op.type == AND || op.type == NOR)k.invert(dst, base, w);
+      else k.accumulate(AND, dst, base, w);
+      continue;
+    }
+    GateType fold = op.type == NAND ? AND : op.type == NOR ? OR : op.type;
+    if (op.faninCount == 1)k.gate2(AND, dst, base + in[0] * w, base + in[0] * w, w);
+    else k.gate2(fold, dst, base + in[0] * w, base + in[1] * w, w);
+    for (int i = 2;i < op.faninCount;i++)k.accumulate(fold, dst, base + in[i] * w, w);
+    if (op.type == NAND || op.type == NOR)k.invert(dst, dst, w);
+  }
+}
+const uint64_t* BatchEvaluator::GetState(int node) const {
+  return this->values.data() + (size_t)this->netlist->nodeValue[node] * this->words;
+}
+
+bool TruthTable::Get(int output, uint64_t row) const {
+  return (this->bits[output][row / 64] >> (row % 64)) & 1;
+}
+
+bool SweepTruthTable(const Netlist& netlist, TruthTable& table, int maxInputs, const GateKernels* kernels) {
+  // Feedback loops make the outputs depend on history, a truth table only makes sense without them
+  if (netlist.cyclic)return false;
+  table.inputs = netlist.sources;
+  table.outputs.clear();
+  for (const NetOp& op : netlist.ops) {
+    if (op.kind == NODE_SINK)table.outputs.push_back(op.node);
+  }
+  int inputCount = (int)table.inputs.size();
+  if (inputCount > maxInputs)return false;
+  table.rows = 1ull << inputCount;
+
+  const GateKernels& k = kernels ? *kernels : GetKernels();
+  int wordBits = 0;
+  while ((1 << wordBits) < k.words)wordBits++;
+  uint64_t totalWords = (table.rows + 63) / 64;
+  uint64_t words = (uint64_t)k.words < totalWords ? (uint64_t)k.words : totalWords;
+  uint64_t blocks = (totalWords + words - 1) / words;
+  uint64_t mask = table.rows < 64 ? (1ull << table.rows) - 1 : ~0ull;
+  table.bits.assign(table.outputs.size(), std::vector<uint64_t>(totalWords, 0));
+
+  // Every block covers 64 * words consecutive rows. Inputs below the sixth vary inside a word,
+  // the next ones select the word inside the block and the rest are constant for the whole block.
+  BatchEvaluator evaluator(&netlist, (int)words, &k);
+  for (uint64_t block = 0;block < blocks;block++) {
+    for (int i = 0;i < inputCount;i++) {
+      uint64_t* lanes = evaluator.GetSource(table.inputs[i]);
+      for (uint64_t w = 0;w < words;w++) {
+        if (i < 6)lanes[w] = lanePattern[i];
+        else if (i < 6 + wordBits)lanes[w] = ((w >> (i - 6)) & 1) ? ~0ull : 0;
+        else lanes[w] = ((block >> (i - 6 - wordBits)) & 1) ? ~0ull : 0;
+      }
+    }
+    evaluator.Evaluate();
+    for (size_t o = 0;o < table.outputs.size();o++) {
+      const uint64_t* state = evaluator.GetState(table.outputs[o]);
+      for (uint64_t w = 0;w < words;w++)table.bits[o][block * words + w] = state[w] & mask;
+    }
+  }
+  return true;
+}
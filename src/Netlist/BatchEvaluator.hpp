@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Netlist.hpp"
+#include "Kernels.hpp"
+
+// Evaluates a compiled netlist for 64 * words stimulus patterns in one pass.
+// Every net owns `words` consecutive 64-bit words, bit i of word w is lane 64 * w + i.
+class BatchEvaluator {
+public:
+  const Netlist* netlist;
+  const GateKernels* kernels;
+  int words;
+  std::vector<uint64_t> values; // Net n lives in values[n * words, (n + 1) * words), net 0 stays all zero
+  BatchEvaluator(const Netlist* netlist, int words = 1, const GateKernels* kernels = nullptr);
+  void Reset();
+  uint64_t* GetSource(int node); // Words of a source node to be filled before Evaluate
+  void Evaluate();
+  const uint64_t* GetState(int node) const;
+};
+
+// Exhaustive truth table of a combinational netlist
+typedef struct TruthTable {
+  std::vector<int> inputs;                 // Source nodes, inputs[0] is the least significant bit of the row index
+  std::vector<int> outputs;                // Sink nodes
+  std::vector<std::vector<uint64_t>> bits; // Row r of output o is bit (r % 64) of bits[o][r / 64]
+  uint64_t rows;
+  bool Get(int output, uint64_t row) const;
+}TruthTable;
+
+// Sweeps 64 * kernels.words rows per pass using the widest kernels the CPU supports unless told otherwise
+bool SweepTruthTable(const Netlist& netlist, TruthTable& table, int maxInputs = 30, const GateKernels* kernels = nullptr);
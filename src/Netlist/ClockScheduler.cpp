@@ -0,0 +1,48 @@
+#include "ClockScheduler.hpp"
+#include <cmath>
+#include <vector>
+
+ClockScheduler::ClockScheduler() {
+  this->now = 0;
+  this->Reset(0);
+}
+void ClockScheduler::Reset(int nodeCount) {
+  // The current time is kept so a recompiled board carries on where it left off
+  this->hertz.assign(nodeCount, 0.0);
+  this->start.assign(nodeCount, 0);
+  this->edges.assign(nodeCount, 0);
+  this->version.assign(nodeCount, 0);
+  this->state.assign(nodeCount, 0);
+  this->queue = std::priority_queue<ClockEdge, std::vector<ClockEdge>, std::greater<ClockEdge>>();
+}
+SimTime ClockScheduler::EdgeTime(int node, unsigned long long edge) const {
+  return this->start[node] + (SimTime)std::llround((double)edge * (double)SIM_SECOND / this->hertz[node]);
+}
+void ClockScheduler::SetClock(int node, double hertz, bool state) {
+  this->hertz[node] = hertz > 0 ? hertz : 0.0;
+  this->start[node] = this->now;
+  this->edges[node] = 0;
+  this->state[node] = state;
+  this->version[node]++;
+  if (this->hertz[node] > 0)this->queue.push({ this->EdgeTime(node, 1), node, this->version[node] });
+}
+SimTime ClockScheduler::NextEdge() {
+  // Drop the edges of clocks that were changed since they got queued
+  while (!this->queue.empty() && this->queue.top().version != this->version[this->queue.top().node])this->queue.pop();
+  return this->queue.empty() ? SIM_NEVER : this->queue.top().time;
+}
+void ClockScheduler::AdvanceTo(SimTime time, std::vector<int>& toggled) {
+  while (!this->queue.empty() && this->queue.top().time <= time) {
+    ClockEdge edge = this->queue.top();
+    this->queue.pop();
+    if (edge.version != this->version[edge.node])continue;
+    this->state[edge.node] = !this->state[edge.node];
+    toggled.push_back(edge.node);
+    unsigned long long next = ++this->edges[edge.node] + 1;
+    this->queue.push({ this->EdgeTime(edge.node, next), edge.node, edge.version });
+  }
+  if (time > this->now)this->now = time;
+}
+bool ClockScheduler::GetState(int node) const {
+  return this->state[node];
+}
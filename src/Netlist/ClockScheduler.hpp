@@ -0,0 +1,37 @@
+#pragma once
+#include <queue>
+#include <vector>
+
+typedef unsigned long long SimTime; // Virtual simulation time in picoseconds
+static const SimTime SIM_SECOND = 1000000000000ull;
+static const SimTime SIM_NEVER = ~0ull;
+
+typedef struct ClockEdge {
+  SimTime time;
+  int node;
+  unsigned int version; // Edges queued before the clock was last changed are dropped
+  bool operator>(const ClockEdge& other) const {
+    return time != other.time ? time > other.time : node > other.node;
+  }
+}ClockEdge;
+
+// Orders the edges of every Clock by virtual timestamp. A clock of `hertz` toggles every 1 / hertz seconds,
+// edge k after a (re)start lands exactly on start + k / hertz so long runs do not drift.
+class ClockScheduler {
+public:
+  SimTime now;
+  std::vector<double> hertz; // 0 for every node that is not a running clock
+  std::vector<SimTime> start;
+  std::vector<unsigned long long> edges;
+  std::vector<unsigned int> version;
+  std::vector<unsigned char> state;
+  std::priority_queue<ClockEdge, std::vector<ClockEdge>, std::greater<ClockEdge>> queue;
+  ClockScheduler();
+  void Reset(int nodeCount);
+  void SetClock(int node, double hertz, bool state); // Restarts the phase of the clock at the current time
+  SimTime NextEdge();
+  SimTime EdgeTime(int node, unsigned long long edge) const;
+  // Fires every edge up to and including time in timestamp order (ties by node) and appends the toggled nodes
+  void AdvanceTo(SimTime time, std::vector<int>& toggled);
+  bool GetState(int node) const;
+};
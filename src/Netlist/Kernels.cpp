@@ -0,0 +1,155 @@
+#include "Kernels.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GATEWORKS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Scalar kernels, also used for the tail words of the SIMD ones
+static void ScalarGate2(GateType type, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words) {
+  switch (type) {
+  case AND: for (size_t i = 0;i < words;i++)dst[i] = a[i] & b[i]; break;
+  case OR: for (size_t i = 0;i < words;i++)dst[i] = a[i] | b[i]; break;
+  case XOR: for (size_t i = 0;i < words;i++)dst[i] = a[i] ^ b[i]; break;
+  case NAND: for (size_t i = 0;i < words;i++)dst[i] = ~(a[i] & b[i]); break;
+  case NOR: for (size_t i = 0;i < words;i++)dst[i] = ~(a[i] | b[i]); break;
+  case NOT: for (size_t i = 0;i < words;i++)dst[i] = ~a[i]; break;
+  }
+}
+static void ScalarAccumulate(GateType type, uint64_t* dst, const uint64_t* src, size_t words) {
+  switch (type) {
+  case AND:
+  case NAND: for (size_t i = 0;i < words;i++)dst[i] &= src[i]; break;
+  case OR:
+  case NOR: for (size_t i = 0;i < words;i++)dst[i] |= src[i]; break;
+  case XOR: for (size_t i = 0;i < words;i++)dst[i] ^= src[i]; break;
+  case NOT: break;
+  }
+}
+static void ScalarInvert(uint64_t* dst, const uint64_t* src, size_t words) {
+  for (size_t i = 0;i < words;i++)dst[i] = ~src[i];
+}
+
+#ifdef GATEWORKS_X86_KERNELS
+// AVX2 kernels, compiled for the target on their own so the rest of the program does not need -mavx2
+__attribute__((target("avx2")))
+static void Avx2Gate2(GateType type, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  size_t i = 0;
+  for (;i + 4 <= words;i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+    __m256i r;
+    switch (type) {
+    case AND: r = _mm256_and_si256(x, y); break;
+    case OR: r = _mm256_or_si256(x, y); break;
+    case XOR: r = _mm256_xor_si256(x, y); break;
+    case NAND: r = _mm256_xor_si256(_mm256_and_si256(x, y), ones); break;
+    case NOR: r = _mm256_xor_si256(_mm256_or_si256(x, y), ones); break;
+    default: r = _mm256_xor_si256(x, ones); break;
+    }
+    _mm256_storeu_si256((__m256i*)(dst + i), r);
+  }
+  ScalarGate2(type, dst + i, a + i, b + i, words - i);
+}
+__attribute__((target("avx2")))
+static void Avx2Accumulate(GateType type, uint64_t* dst, const uint64_t* src, size_t words) {
+  if (type == NOT)return;
+  size_t i = 0;
+  for (;i + 4 <= words;i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(dst + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i r;
+    if (type == AND || type == NAND)r = _mm256_and_si256(x, y);
+    else if (type == OR || type == NOR)r = _mm256_or_si256(x, y);
+    else r = _mm256_xor_si256(x, y);
+    _mm256_storeu_si256((__m256i*)(dst + i), r);
+  }
+  ScalarAccumulate(type, dst + i, src + i, words - i);
+}
+__attribute__((target("avx2")))
+static void Avx2Invert(uint64_t* dst, const uint64_t* src, size_t words) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  size_t i = 0;
+  for (;i + 4 <= words;i += 4) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(src + i));
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm256_xor_si256(x, ones));
+  }
+  ScalarInvert(dst + i, src + i, words - i);
+}
+
+// AVX-512 kernels, NAND and NOR fold the inversion into a single ternary logic instruction
+__attribute__((target("avx512f")))
+static void Avx512Gate2(GateType type, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words) {
+  size_t i = 0;
+  for (;i + 8 <= words;i += 8) {
+    __m512i x = _mm512_loadu_si512((const void*)(a + i));
+    __m512i y = _mm512_loadu_si512((const void*)(b + i));
+    __m512i r;
+    switch (type) {
+    case AND: r = _mm512_and_si512(x, y); break;
+    case OR: r = _mm512_or_si512(x, y); break;
+    case XOR: r = _mm512_xor_si512(x, y); break;
+    case NAND: r = _mm512_ternarylogic_epi64(x, y, y, 0x3F); break; // ~(x & y)
+    case NOR: r = _mm512_ternarylogic_epi64(x, y, y, 0x03); break;  // ~(x | y)
+    default: r = _mm512_ternarylogic_epi64(x, x, x, 0x0F); break;   // ~x
+    }
+    _mm512_storeu_si512((void*)(dst + i), r);
+  }
+  ScalarGate2(type, dst + i, a + i, b + i, words - i);
+}
+__attribute__((target("avx512f")))
+static void Avx512Accumulate(GateType type, uint64_t* dst, const uint64_t* src, size_t words) {
+  if (type == NOT)return;
+  size_t i = 0;
+  for (;i + 8 <= words;i += 8) {
+    __m512i x = _mm512_loadu_si512((const void*)(dst + i));
+    __m512i y = _mm512_loadu_si512((const void*)(src + i));
+    __m512i r;
+    if (type == AND || type == NAND)r = _mm512_and_si512(x, y);
+    else if (type == OR || type == NOR)r = _mm512_or_si512(x, y);
+    else r = _mm512_xor_si512(x, y);
+    _mm512_storeu_si512((void*)(dst + i), r);
+  }
+  ScalarAccumulate(type, dst + i, src + i, words - i);
+}
+__attribute__((target("avx512f")))
+static void Avx512Invert(uint64_t* dst, const uint64_t* src, size_t words) {
+  size_t i = 0;
+  for (;i + 8 <= words;i += 8) {
+    __m512i x = _mm512_loadu_si512((const void*)(src + i));
+    _mm512_storeu_si512((void*)(dst + i), _mm512_ternarylogic_epi64(x, x, x, 0x0F));
+  }
+  ScalarInvert(dst + i, src + i, words - i);
+}
+#endif
+
+static const GateKernels scalarKernels = { KERNEL_SCALAR, "scalar", 1, ScalarGate2, ScalarAccumulate, ScalarInvert };
+#ifdef GATEWORKS_X86_KERNELS
+static const GateKernels avx2Kernels = { KERNEL_AVX2, "avx2", 4, Avx2Gate2, Avx2Accumulate, Avx2Invert };
+static const GateKernels avx512Kernels = { KERNEL_AVX512, "avx512", 8, Avx512Gate2, Avx512Accumulate, Avx512Invert };
+#endif
+
+KernelLevel DetectKernelLevel() {
+#ifdef GATEWORKS_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))return KERNEL_AVX512;
+  if (__builtin_cpu_supports("avx2"))return KERNEL_AVX2;
+#endif
+  return KERNEL_SCALAR;
+}
+const GateKernels& GetKernels(KernelLevel level) {
+#ifdef GATEWORKS_X86_KERNELS
+  KernelLevel supported = DetectKernelLevel();
+  if (level > supported)level = supported;
+  if (level == KERNEL_AVX512)return avx512Kernels;
+  if (level == KERNEL_AVX2)return avx2Kernels;
+#endif
+  return scalarKernels;
+}
+const GateKernels& GetKernels() {
+  static const GateKernels& kernels = GetKernels(DetectKernelLevel());
+  return kernels;
+}
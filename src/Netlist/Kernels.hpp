@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Netlist.hpp"
+
+typedef enum KernelLevel {
+  KERNEL_SCALAR, // Plain 64-bit words, always available
+  KERNEL_AVX2,   // 256 lanes per instruction
+  KERNEL_AVX512  // 512 lanes per instruction
+}KernelLevel;
+
+// Gate kernels working on runs of 64-bit lane words
+typedef struct GateKernels {
+  KernelLevel level;
+  const char* name;
+  int words; // Words handled per instruction, the natural batch width of the kernels
+  // dst = a <type> b for every word, including the inversion of NAND and NOR
+  void (*gate2)(GateType type, uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t words);
+  // dst = dst <type> src without the inversion, used to fold fan-ins beyond the second one
+  void (*accumulate)(GateType type, uint64_t* dst, const uint64_t* src, size_t words);
+  // dst = ~src
+  void (*invert)(uint64_t* dst, const uint64_t* src, size_t words);
+}GateKernels;
+
+KernelLevel DetectKernelLevel();
+const GateKernels& GetKernels(KernelLevel level); // Falls back to the widest level below that is available
+const GateKernels& GetKernels();                  // Widest level the CPU supports
@@ -0,0 +1,322 @@
+#include "Netlist.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+NetDescription::NetDescription() {
+  this->freePins = 0;
+}
+void NetDescription::Clear() {
+  this->nodes.clear();
+  this->pins.clear();
+  this->freePins = 0;
+}
+// Appends a node with all its inputs open and returns its index
+int NetDescription::AddNode(NodeKind kind, GateType type, int outputCount, bool state, int inputCount) {
+  this->nodes.push_back({ kind, type, outputCount, state, (int)this->pins.size(), inputCount });
+  this->pins.insert(this->pins.end(), inputCount, { -1, 0 });
+  return (int)this->nodes.size() - 1;
+}
+// The last node moves into the place of the removed one, references to either are left to the caller
+void NetDescription::RemoveNode(int node) {
+  this->freePins += this->nodes[node].inputCount;
+  this->nodes[node] = this->nodes.back();
+  this->nodes.pop_back();
+  if (this->freePins * 2 <= (int)this->pins.size())return;
+  // Compact the pins in node order
+  std::vector<PinRef> compacted;
+  compacted.reserve(this->pins.size() - this->freePins);
+  for (NetNode& n : this->nodes) {
+    compacted.insert(compacted.end(), this->pins.begin() + n.inputBegin, this->pins.begin() + n.inputBegin + n.inputCount);
+    n.inputBegin = (int)compacted.size() - n.inputCount;
+  }
+  this->pins.swap(compacted);
+  this->freePins = 0;
+}
+PinRef* NetDescription::Inputs(int node) {
+  return this->pins.data() + this->nodes[node].inputBegin;
+}
+const PinRef* NetDescription::Inputs(int node) const {
+  return this->pins.data() + this->nodes[node].inputBegin;
+}
+int NetDescription::Size() const {
+  return (int)this->nodes.size();
+}
+
+Netlist::Netlist() {
+  this->levels = 0;
+  this->cyclic = false;
+  this->Clear();
+}
+void Netlist::Clear() {
+  this->ops.clear();
+  this->fanin.clear();
+  this->nodeOutput.clear();
+  this->nodeValue.clear();
+  this->sources.clear();
+  this->nodeOp.clear();
+  this->netFanoutBegin.clear();
+  this->netFanout.clear();
+  this->buckets.clear();
+  this->deferred.clear();
+  this->queued.clear();
+  this->changed.clear();
+  this->values.assign(1, 0);
+  this->levels = 0;
+  this->cyclic = false;
+}
+void Netlist::Compile(const NetDescription& description) {
+  this->Clear();
+  const std::vector<NetNode>& nodes = description.nodes;
+  int nodeCount = (int)nodes.size();
+
+  // Give every output pin its own net, net 0 stays the constant low net
+  int netCount = 1;
+  this->nodeOutput.resize(nodeCount);
+  for (int i = 0;i < nodeCount;i++) {
+    this->nodeOutput[i] = netCount;
+    netCount += nodes[i].outputCount;
+  }
+  this->values.assign(netCount, 0);
+
+  // Build the node level fan-out lists (CSR) and the in-degree of every node
+  std::vector<int> indegree(nodeCount, 0);
+  std::vector<int> fanoutBegin(nodeCount + 1, 0);
+  for (int i = 0;i < nodeCount;i++) {
+    const PinRef* inputs = description.Inputs(i);
+    for (int j = 0;j < nodes[i].inputCount;j++) {
+      const PinRef& ref = inputs[j];
+      if (ref.node < 0 || ref.node >= nodeCount)continue;
+      fanoutBegin[ref.node + 1]++;
+      indegree[i]++;
+    }
+  }
+  for (int i = 0;i < nodeCount;i++)fanoutBegin[i + 1] += fanoutBegin[i];
+  std::vector<int> fanout(fanoutBegin[nodeCount]);
+  std::vector<int> cursor(fanoutBegin.begin(), fanoutBegin.end() - 1);
+  for (int i = 0;i < nodeCount;i++) {
+    const PinRef* inputs = description.Inputs(i);
+    for (int j = 0;j < nodes[i].inputCount;j++) {
+      const PinRef& ref = inputs[j];
+      if (ref.node < 0 || ref.node >= nodeCount)continue;
+      fanout[cursor[ref.node]++] = i;
+    }
+  }
+
+  // Levelize with Kahn's algorithm, a node sits one level above its deepest driver
+  std::vector<int> level(nodeCount, 0);
+  std::vector<int> order;
+  order.reserve(nodeCount);
+  for (int i = 0;i < nodeCount;i++) {
+    if (indegree[i] == 0)order.push_back(i);
+  }
+  size_t head = 0;
+  int nextForced = 0;
+  while ((int)order.size() < nodeCount || head < order.size()) {
+    if (head == order.size()) {
+      // Only feedback loops are left, break one open at its lowest index node.
+      // It goes above everything placed so far and reads its back edges from the last tick.
+      while (indegree[nextForced] <= 0)nextForced++;
+      this->cyclic = true;
+      level[nextForced] = this->levels;
+      indegree[nextForced] = 0;
+      order.push_back(nextForced);
+    }
+    int node = order[head++];
+    indegree[node] = -1;
+    if (level[node] + 1 > this->levels)this->levels = level[node] + 1;
+    for (int j = fanoutBegin[node];j < fanoutBegin[node + 1];j++) {
+      int next = fanout[j];
+      if (indegree[next] < 0)continue;
+      if (level[node] + 1 > level[next])level[next] = level[node] + 1;
+      if (--indegree[next] == 0)order.push_back(next);
+    }
+  }
+
+  // Counting sort of the nodes by level
+  std::vector<int> levelBegin(this->levels + 1, 0);
+  for (int i = 0;i < nodeCount;i++)levelBegin[level[i] + 1]++;
+  for (int l = 0;l < this->levels;l++)levelBegin[l + 1] += levelBegin[l];
+  std::vector<int> sorted(nodeCount);
+  for (int node : order)sorted[levelBegin[level[node]]++] = node;
+
+  // Emit the flat op array
+  this->ops.reserve(nodeCount);
+  this->nodeValue.resize(nodeCount);
+  this->nodeOp.resize(nodeCount);
+  for (int node : sorted) {
+    const NetNode& n = nodes[node];
+    const PinRef* inputs = description.Inputs(node);
+    NetOp op;
+    op.kind = n.kind;
+    op.type = n.type;
+    op.node = node;
+    op.output = n.kind == NODE_SINK ? -1 : this->nodeOutput[node];
+    op.faninBegin = (int)this->fanin.size();
+    op.level = level[node];
+    for (int j = 0;j < n.inputCount;j++) {
+      const PinRef& ref = inputs[j];
+      bool connected = ref.node >= 0 && ref.node < nodeCount && ref.pin >= 0 && ref.pin < nodes[ref.node].outputCount;
+      // An unconnected NOT gate stays low, every other gate reads its open inputs as low
+      if (!connected && n.kind == NODE_GATE && n.type == NOT)continue;
+      this->fanin.push_back(connected ? this->nodeOutput[ref.node] + ref.pin : 0);
+    }
+    op.faninCount = (int)this->fanin.size() - op.faninBegin;
+    this->nodeOp[node] = (int)this->ops.size();
+    this->ops.push_back(op);
+
+    if (n.kind == NODE_SINK)this->nodeValue[node] = op.faninCount > 0 ? this->fanin[op.faninBegin] : 0;
+    else this->nodeValue[node] = this->nodeOutput[node];
+    if (n.kind == NODE_SOURCE)this->sources.push_back(node);
+    if (op.output >= 0 && n.outputCount > 0)this->values[op.output] = n.state;
+  }
+
+  // Net fan-out lists for the event driven mode
+  int opCount = (int)this->ops.size();
+  this->netFanoutBegin.assign(netCount + 1, 0);
+  for (int net : this->fanin)this->netFanoutBegin[net + 1]++;
+  for (int i = 0;i < netCount;i++)this->netFanoutBegin[i + 1] += this->netFanoutBegin[i];
+  this->netFanout.resize(this->fanin.size());
+  std::vector<int> netCursor(this->netFanoutBegin.begin(), this->netFanoutBegin.end() - 1);
+  for (int i = 0;i < opCount;i++) {
+    const NetOp& op = this->ops[i];
+    for (int j = op.faninBegin;j < op.faninBegin + op.faninCount;j++) {
+      this->netFanout[netCursor[this->fanin[j]]++] = i;
+    }
+  }
+  this->buckets.assign(this->levels, std::vector<int>());
+  this->queued.assign(opCount, 0);
+}
+// Patches the fan-in of one input pin after it was connected or disconnected in the description. Returns false
+// when the change needs a new levelization (the driver is not below the gate, or a read that may close a feedback
+// loop is dropped) or a new fan-in layout (an open NOT gate has no fan-in slot), the caller compiles the whole
+// netlist again then.
+bool Netlist::Reconnect(const NetDescription& description, int node, int pin) {
+  if (node < 0 || node >= (int)this->nodeOp.size() || description.Size() != (int)this->nodeOp.size())return false;
+  int index = this->nodeOp[node];
+  NetOp& op = this->ops[index];
+  if (op.faninCount != description.nodes[node].inputCount || pin < 0 || pin >= op.faninCount)return false;
+  const PinRef& ref = description.Inputs(node)[pin];
+  int net = 0;
+  if (ref.node >= 0 && ref.node < description.Size() && ref.pin >= 0 && ref.pin < description.nodes[ref.node].outputCount) {
+    if (op.kind == NODE_GATE && this->ops[this->nodeOp[ref.node]].level >= op.level)return false;
+    net = this->nodeOutput[ref.node] + ref.pin;
+  }
+  else if (op.kind == NODE_GATE && op.type == NOT)return false;
+  int& slot = this->fanin[op.faninBegin + pin];
+  if (slot == net)return true;
+  // Any connection removed from a board with feedback loops may open the last of them, cyclic has to be found again
+  if (this->cyclic && slot != 0)return false;
+  this->MoveFanout(index, slot, net);
+  slot = net;
+  if (op.kind == NODE_SINK)this->nodeValue[node] = net;
+  // The event driven mode re-evaluates the op on the next tick
+  if (!this->queued[index]) {
+    this->queued[index] = 1;
+    this->buckets[op.level].push_back(index);
+  }
+  return true;
+}
+// Moves one reader of net `from` over to net `to`, the fan-out entries between the two lists shift by one slot
+void Netlist::MoveFanout(int op, int from, int to) {
+  int j = this->netFanoutBegin[from];
+  while (this->netFanout[j] != op)j++;
+  if (from < to) {
+    int last = this->netFanoutBegin[to + 1] - 1;
+    std::copy(this->netFanout.begin() + j + 1, this->netFanout.begin() + last + 1, this->netFanout.begin() + j);
+    this->netFanout[last] = op;
+    for (int net = from + 1;net <= to;net++)this->netFanoutBegin[net]--;
+  }
+  else {
+    int first = this->netFanoutBegin[to + 1];
+    std::copy_backward(this->netFanout.begin() + first, this->netFanout.begin() + j, this->netFanout.begin() + j + 1);
+    this->netFanout[first] = op;
+    for (int net = to + 1;net <= from;net++)this->netFanoutBegin[net]++;
+  }
+}
+void Netlist::SetSource(int node, bool value) {
+  this->values[this->nodeOutput[node]] = value;
+}
+bool Netlist::EvaluateGate(const NetOp& op) const {
+  const int* in = this->fanin.data() + op.faninBegin;
+  if (op.type == NOT)return op.faninCount > 0 ? !this->values[in[0]] : false;
+  bool state = (op.type == OR || op.type == XOR || op.type == NOR) ? false : true;
+  for (int i = 0;i < op.faninCount;i++) {
+    bool val = this->values[in[i]];
+    switch (op.type) {
+    case AND:
+    case NAND:
+      state = state & val;
+      break;
+    case OR:
+    case NOR:
+      state = state | val;
+      break;
+    case XOR:
+      state = state ^ val;
+      break;
+    default:
+      state = false;
+    }
+  }
+  return (op.type == NAND || op.type == NOR) ? !state : state;
+}
+void Netlist::Evaluate() {
+  // One pass in level order, every net is final by the time it is read
+  for (const NetOp& op : this->ops) {
+    if (op.kind != NODE_GATE)continue;
+    this->values[op.output] = this->EvaluateGate(op);
+  }
+}
+void Netlist::DriveSource(int node, bool value) {
+  int net = this->nodeOutput[node];
+  if (this->values[net] == value)return;
+  this->values[net] = value;
+  this->changed.push_back(node);
+  this->Schedule(net, -1);
+}
+void Netlist::Schedule(int net, int currentLevel) {
+  for (int j = this->netFanoutBegin[net];j < this->netFanoutBegin[net + 1];j++) {
+    int op = this->netFanout[j];
+    if (this->queued[op])continue;
+    this->queued[op] = 1;
+    // Anything at or below the level being drained can only be reached through a feedback loop,
+    // it waits for the next tick just like it would read last tick's value in a full sweep
+    if (this->ops[op].level > currentLevel)this->buckets[this->ops[op].level].push_back(op);
+    else this->deferred.push_back(op);
+  }
+}
+void Netlist::ScheduleAll() {
+  for (auto& bucket : this->buckets)bucket.clear();
+  this->deferred.clear();
+  for (int i = 0;i < (int)this->ops.size();i++) {
+    this->queued[i] = 1;
+    this->buckets[this->ops[i].level].push_back(i);
+  }
+}
+void Netlist::Propagate() {
+  for (int op : this->deferred)this->buckets[this->ops[op].level].push_back(op);
+  this->deferred.clear();
+  for (int level = 0;level < this->levels;level++) {
+    std::vector<int>& bucket = this->buckets[level];
+    for (size_t i = 0;i < bucket.size();i++) {
+      const NetOp& op = this->ops[bucket[i]];
+      this->queued[bucket[i]] = 0;
+      if (op.kind == NODE_SINK) {
+        this->changed.push_back(op.node);
+        continue;
+      }
+      if (op.kind != NODE_GATE)continue;
+      bool value = this->EvaluateGate(op);
+      // Propagation stops wherever an output does not change
+      if (this->values[op.output] == value)continue;
+      this->values[op.output] = value;
+      this->changed.push_back(op.node);
+      this->Schedule(op.output, level);
+    }
+    bucket.clear();
+  }
+}
+bool Netlist::GetState(int node) const {
+  return this->values[this->nodeValue[node]];
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+
+typedef enum GateType {
+  AND, OR, NOT, NOR, NAND, XOR
+}GateType;
+
+// What a component turns into once the board is compiled
+typedef enum NodeKind {
+  NODE_SOURCE, // Switches and Clocks, their value is pushed in from outside
+  NODE_GATE,
+  NODE_SINK    // Bulbs, they only observe the net on their input
+}NodeKind;
+
+// Reference to an output pin of a node, node = -1 means the pin is not connected
+typedef struct PinRef {
+  int node;
+  int pin;
+}PinRef;
+
+// Description of a single component, its input pins are NetDescription::pins[inputBegin, inputBegin + inputCount)
+typedef struct NetNode {
+  NodeKind kind;
+  GateType type;
+  int outputCount;
+  bool state;
+  int inputBegin;
+  int inputCount;
+}NetNode;
+
+// Flat description of a board handed to Netlist::Compile, the input pins of all the nodes share one array
+class NetDescription {
+public:
+  std::vector<NetNode> nodes;
+  std::vector<PinRef> pins;
+  int freePins; // Pins of removed nodes still in the array, it is compacted once they are half of it
+  NetDescription();
+  void Clear();
+  int AddNode(NodeKind kind, GateType type, int outputCount, bool state, int inputCount);
+  void RemoveNode(int node);
+  PinRef* Inputs(int node);
+  const PinRef* Inputs(int node) const;
+  int Size() const;
+};
+
+// One levelized operation, its fan-in nets are fanin[faninBegin, faninBegin + faninCount)
+typedef struct NetOp {
+  NodeKind kind;
+  GateType type;
+  int node;
+  int output; // Net driven by this op, -1 for the sinks
+  int faninBegin;
+  int faninCount;
+  int level;
+}NetOp;
+
+class Netlist {
+public:
+  std::vector<NetOp> ops;            // Sorted by level so every op comes after its drivers
+  std::vector<int> fanin;            // Flat fan-in net indices of all the ops
+  std::vector<unsigned char> values; // Net values, net 0 is the constant low net
+  std::vector<int> nodeOutput;       // First output net of every node
+  std::vector<int> nodeValue;        // Net holding the visible state of every node
+  std::vector<int> sources;          // Indices of all the source nodes
+  std::vector<int> nodeOp;           // Op of every node
+  int levels;
+  bool cyclic; // Set when feedback loops were found, those ops read last tick's values
+
+  // Event driven propagation
+  std::vector<int> netFanoutBegin;       // CSR of the ops reading every net
+  std::vector<int> netFanout;
+  std::vector<std::vector<int>> buckets; // Ops waiting to be evaluated, one bucket per level
+  std::vector<int> deferred;             // Ops re-triggered through a feedback loop, evaluated next tick
+  std::vector<unsigned char> queued;
+  std::vector<int> changed;              // Nodes whose state changed, the caller clears it once consumed
+  Netlist();
+  void Clear();
+  void Compile(const NetDescription& description);
+  bool Reconnect(const NetDescription& description, int node, int pin);
+  void MoveFanout(int op, int from, int to);
+  void SetSource(int node, bool value);
+  bool EvaluateGate(const NetOp& op) const;
+  void Evaluate();
+  void DriveSource(int node, bool value);
+  void Schedule(int net, int currentLevel);
+  void ScheduleAll();
+  void Propagate();
+  bool GetState(int node) const;
+};
@@ -0,0 +1,174 @@
+#include "SimulationThread.hpp"
+#include "ClockScheduler.hpp"
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const int FRESH = 4;
+
+SimulationThread::SimulationThread() {
+  this->running = false;
+  this->tickRate = 1000.0;
+  this->pendingLoad = false;
+  this->pendingEventDriven = false;
+  this->generation = 0;
+  this->back = 0;
+  this->latest = 1;
+  this->front = 2;
+}
+SimulationThread::~SimulationThread() {
+  this->Stop();
+}
+void SimulationThread::Start() {
+  if (this->running)return;
+  this->running = true;
+  this->worker = std::thread(&SimulationThread::Run, this);
+}
+void SimulationThread::Stop() {
+  this->running = false;
+  if (this->worker.joinable())this->worker.join();
+}
+bool SimulationThread::IsRunning() const {
+  return this->running;
+}
+unsigned int SimulationThread::Load(const Netlist& netlist, const std::vector<double>& clockHertz, bool eventDriven) {
+  std::lock_guard<std::mutex> lock(this->commandMutex);
+  this->pendingNetlist = netlist;
+  this->pendingClocks = clockHertz;
+  this->pendingEventDriven = eventDriven;
+  this->pendingLoad = true;
+  // Commands for the old netlist refer to the wrong nodes now
+  this->pendingSources.clear();
+  this->pendingClockChanges.clear();
+  return ++this->generation;
+}
+void SimulationThread::SetSource(int node, bool value) {
+  std::lock_guard<std::mutex> lock(this->commandMutex);
+  this->pendingSources.push_back({ node, value });
+}
+void SimulationThread::SetClock(int node, double hertz) {
+  std::lock_guard<std::mutex> lock(this->commandMutex);
+  this->pendingClockChanges.push_back({ node, hertz });
+}
+void SimulationThread::SetEventDriven(bool eventDriven) {
+  std::lock_guard<std::mutex> lock(this->commandMutex);
+  this->pendingEventDriven = eventDriven;
+}
+void SimulationThread::SetTickRate(double ticksPerSecond) {
+  if (ticksPerSecond > 0)this->tickRate = ticksPerSecond;
+}
+double SimulationThread::GetTickRate() const {
+  return this->tickRate;
+}
+void SimulationThread::Publish(unsigned int generation, unsigned long long tick, const std::vector<unsigned char>& values) {
+  NetSnapshot& snapshot = this->buffers[this->back];
+  snapshot.generation = generation;
+  snapshot.tick = tick;
+  snapshot.values.assign(values.begin(), values.end());
+  this->back = this->latest.exchange(this->back | FRESH) & 3;
+}
+bool SimulationThread::ReadSnapshot(NetSnapshot& snapshot) {
+  if (!(this->latest.load() & FRESH))return false;
+  this->front = this->latest.exchange(this->front) & 3;
+  const NetSnapshot& newest = this->buffers[this->front];
+  snapshot.generation = newest.generation;
+  snapshot.tick = newest.tick;
+  snapshot.values.assign(newest.values.begin(), newest.values.end());
+  return true;
+}
+void SimulationThread::Run() {
+  typedef std::chrono::steady_clock SteadyClock;
+  // State owned by the simulation thread
+  Netlist netlist;
+  ClockScheduler scheduler;
+  std::vector<unsigned char> sourceValue;
+  std::vector<int> toggled;
+  bool loaded = false, eventDriven = false, inputChanged = false;
+  unsigned int loadedGeneration = 0;
+  unsigned long long tick = 0;
+  double dueTicks = 0;
+  auto last = SteadyClock::now();
+
+  while (this->running) {
+    {
+      std::lock_guard<std::mutex> lock(this->commandMutex);
+      if (this->pendingLoad) {
+        netlist = std::move(this->pendingNetlist);
+        int nodeCount = (int)this->pendingClocks.size();
+        sourceValue.assign(nodeCount, 0);
+        scheduler.Reset(nodeCount);
+        for (int node : netlist.sources) {
+          sourceValue[node] = netlist.values[netlist.nodeOutput[node]];
+          scheduler.SetClock(node, this->pendingClocks[node], sourceValue[node]);
+        }
+        loadedGeneration = this->generation;
+        this->pendingLoad = false;
+        loaded = true;
+        inputChanged = true;
+        if (this->pendingEventDriven)netlist.ScheduleAll();
+      }
+      if (loaded && !eventDriven && this->pendingEventDriven)netlist.ScheduleAll();
+      eventDriven = this->pendingEventDriven;
+      for (auto& source : this->pendingSources) {
+        if (source.first < 0 || source.first >= (int)sourceValue.size())continue;
+        sourceValue[source.first] = source.second;
+        inputChanged = true;
+      }
+      for (auto& clock : this->pendingClockChanges) {
+        if (clock.first < 0 || clock.first >= (int)sourceValue.size())continue;
+        scheduler.SetClock(clock.first, clock.second, scheduler.GetState(clock.first));
+      }
+      this->pendingSources.clear();
+      this->pendingClockChanges.clear();
+    }
+
+    auto now = SteadyClock::now();
+    double elapsed = std::chrono::duration<double>(now - last).count();
+    last = now;
+    double rate = this->tickRate;
+    SimTime period = (SimTime)(SIM_SECOND / rate);
+    if (period == 0)period = 1;
+    dueTicks += elapsed * rate;
+    // A board that cannot keep up runs slower than real time instead of building an ever growing backlog
+    if (dueTicks > rate * 0.1)dueTicks = rate * 0.1;
+    // Work in slices of about 10ms of virtual time so commands and snapshots stay responsive
+    long long batch = (long long)dueTicks;
+    long long slice = (long long)(rate / 100.0);
+    if (slice < 1)slice = 1;
+    if (batch > slice)batch = slice;
+    if (!loaded || batch == 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+      continue;
+    }
+    dueTicks -= batch;
+
+    for (long long i = 0;i < batch;i++) {
+      // An idle event driven netlist has nothing to do before the next clock edge, jump straight to it
+      // Virtual time is the scheduler's own, every tick adds the current period so a rate change never moves it
+      if (eventDriven && !inputChanged && netlist.deferred.empty()) {
+        SimTime edge = scheduler.NextEdge();
+        unsigned long long idle = edge == SIM_NEVER ? ~0ull : edge > scheduler.now ? (edge - scheduler.now - 1) / period : 0;
+        if (idle > (unsigned long long)(batch - i - 1))idle = batch - i - 1;
+        scheduler.now += idle * period;
+        tick += idle;
+        i += idle;
+      }
+      tick++;
+      toggled.clear();
+      scheduler.AdvanceTo(scheduler.now + period, toggled);
+      for (int node : netlist.sources) {
+        bool value = scheduler.hertz[node] > 0 ? scheduler.GetState(node) : sourceValue[node];
+        if (eventDriven)netlist.DriveSource(node, value);
+        else netlist.SetSource(node, value);
+      }
+      if (eventDriven) {
+        netlist.Propagate();
+        netlist.changed.clear();
+      }
+      else netlist.Evaluate();
+      inputChanged = false;
+    }
+    this->Publish(loadedGeneration, tick, netlist.values);
+  }
+}
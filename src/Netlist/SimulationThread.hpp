@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Netlist.hpp"
+
+// Net values published by the simulation thread
+typedef struct NetSnapshot {
+  unsigned int generation; // Load() call the values belong to, stale snapshots of an older netlist are ignored
+  unsigned long long tick;
+  std::vector<unsigned char> values;
+}NetSnapshot;
+
+// Runs a compiled netlist on its own thread at a fixed tick rate of virtual time, independent of the frame rate.
+// Edits come in through a small mutex protected command list, results go out through a lock-free triple buffer.
+class SimulationThread {
+public:
+  SimulationThread();
+  ~SimulationThread();
+  void Start();
+  void Stop();
+  bool IsRunning() const;
+  // clockHertz holds the toggle frequency of every node, 0 for everything that is not a Clock
+  unsigned int Load(const Netlist& netlist, const std::vector<double>& clockHertz, bool eventDriven);
+  void SetSource(int node, bool value);
+  void SetClock(int node, double hertz);
+  void SetEventDriven(bool eventDriven);
+  void SetTickRate(double ticksPerSecond);
+  double GetTickRate() const;
+  bool ReadSnapshot(NetSnapshot& snapshot); // False when nothing new was published since the last read
+
+  std::thread worker;
+  std::atomic<bool> running;
+  std::atomic<double> tickRate;
+
+  // Commands, only touched under commandMutex
+  std::mutex commandMutex;
+  bool pendingLoad;
+  Netlist pendingNetlist;
+  std::vector<double> pendingClocks;
+  bool pendingEventDriven;
+  unsigned int generation;
+  std::vector<std::pair<int, bool>> pendingSources;
+  std::vector<std::pair<int, double>> pendingClockChanges;
+
+  // Triple buffer, the writer owns back, the reader owns front and latest carries a fresh bit
+  NetSnapshot buffers[3];
+  std::atomic<int> latest;
+  int back;
+  int front;
+  void Publish(unsigned int generation, unsigned long long tick, const std::vector<unsigned char>& values);
+  void Run();
+};
@@ -0,0 +1,236 @@
+// gateworks-run: headless batch runner for boards saved by Board::SaveBoard
+//
+// Usage: gateworks-run <board file> [options]
+//   --ticks N          Number of ticks to simulate (default 1)
+//   --rate N           Ticks per second of virtual time (default 1000)
+//   --until SECONDS    Jump from event to event (Clock edges and stimulus) up to this virtual time instead of ticking
+//   --clock ID=HERTZ   Toggle frequency of a Clock (default 1), the save format does not store it
+//   --stimulus FILE    Switch states per tick, see below
+//   --mode sweep|event Levelized full sweep or event driven propagation (default sweep)
+//   --trace            Print the bulb states after every tick
+//   --truth-table      Print the exhaustive truth table of the board instead of simulating
+//
+// Stimulus files hold one line per tick that changes something, `#` starts a comment:
+//   <tick> <component id>=<0|1> ...
+// The listed Switches are set before that tick is evaluated and keep their value afterwards.
+// A Clock listed there is forced to the value and restarts its phase.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../Netlist/Netlist.hpp"
+#include "../Netlist/BatchEvaluator.hpp"
+#include "../Netlist/ClockScheduler.hpp"
+#include "../Serializer/Serializer.hpp"
+
+typedef struct Stimulus {
+  long long tick;
+  int node;
+  bool value;
+}Stimulus;
+
+static bool LoadStimulus(const std::string& fileName, const std::map<std::string, int>& index, std::vector<Stimulus>& stimulus) {
+  std::ifstream file(fileName);
+  if (!file.is_open()) {
+    std::cerr << "Failed to open the stimulus file " << fileName << std::endl;
+    return false;
+  }
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(file, line)) {
+    lineNo++;
+    size_t comment = line.find('#');
+    if (comment != std::string::npos)line.erase(comment);
+    std::istringstream tokens(line);
+    std::string field;
+    if (!(tokens >> field))continue;
+    long long tick;
+    if (!ParseNumber(field, tick)) {
+      std::cerr << fileName << ":" << lineNo << ": bad tick " << field << std::endl;
+      return false;
+    }
+    std::string assignment;
+    while (tokens >> assignment) {
+      size_t eq = assignment.find('=');
+      auto it = index.find(assignment.substr(0, eq));
+      std::string value = eq == std::string::npos ? "" : assignment.substr(eq + 1);
+      if (it == index.end() || (value != "0" && value != "1")) {
+        std::cerr << fileName << ":" << lineNo << ": unknown assignment " << assignment << std::endl;
+        return false;
+      }
+      stimulus.push_back({ tick, it->second, value == "1" });
+    }
+  }
+  return true;
+}
+
+static void PrintTruthTable(const BoardData& data, const TruthTable& table) {
+  for (int input : table.inputs)std::cout << data.components[input].id << " ";
+  std::cout << "|";
+  for (int output : table.outputs)std::cout << " " << data.components[output].id;
+  std::cout << std::endl;
+  for (uint64_t row = 0;row < table.rows;row++) {
+    for (size_t i = 0;i < table.inputs.size();i++)std::cout << ((row >> i) & 1);
+    std::cout << " ";
+    for (size_t o = 0;o < table.outputs.size();o++)std::cout << table.Get((int)o, row);
+    std::cout << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string boardFile, stimulusFile;
+  std::vector<std::string> clockArgs;
+  long long ticks = 1;
+  double rate = 1000.0, until = -1.0;
+  bool eventDriven = false, trace = false, truthTable = false;
+  for (int i = 1;i < argc;i++) {
+    std::string arg = argv[i];
+    bool valid = true;
+    if (arg == "--ticks" && i + 1 < argc)valid = ParseNumber(argv[++i], ticks);
+    else if (arg == "--rate" && i + 1 < argc)valid = ParseNumber(argv[++i], rate);
+    else if (arg == "--until" && i + 1 < argc)valid = ParseNumber(argv[++i], until);
+    else if (arg == "--clock" && i + 1 < argc)clockArgs.push_back(argv[++i]);
+    else if (arg == "--stimulus" && i + 1 < argc)stimulusFile = argv[++i];
+    else if (arg == "--mode" && i + 1 < argc) {
+      std::string mode = argv[++i];
+      valid = mode == "sweep" || mode == "event";
+      eventDriven = mode == "event";
+    }
+    else if (arg == "--trace")trace = true;
+    else if (arg == "--truth-table")truthTable = true;
+    else if (boardFile.empty() && arg[0] != '-')boardFile = arg;
+    else {
+      std::cerr << "Unknown argument " << arg << std::endl;
+      return 2;
+    }
+    if (!valid) {
+      std::cerr << "Unknown argument " << arg << " " << argv[i] << std::endl;
+      return 2;
+    }
+  }
+  if (boardFile.empty()) {
+    std::cerr << "Usage: gateworks-run <board file> [--ticks N] [--rate N] [--until SECONDS] [--clock ID=HERTZ] [--stimulus FILE] [--mode sweep|event] [--trace] [--truth-table]" << std::endl;
+    return 2;
+  }
+
+  BoardData data;
+  if (!LoadBoardFile(boardFile, data)) {
+    std::cerr << "Failed to load the board " << boardFile << std::endl;
+    return 1;
+  }
+  NetDescription description;
+  BuildNetNodes(data, description);
+  const std::vector<NetNode>& nodes = description.nodes;
+  Netlist netlist;
+  netlist.Compile(description);
+
+  if (truthTable) {
+    TruthTable table;
+    if (!SweepTruthTable(netlist, table)) {
+      std::cerr << "The board has feedback loops or too many inputs for a truth table" << std::endl;
+      return 1;
+    }
+    PrintTruthTable(data, table);
+    return 0;
+  }
+
+  std::map<std::string, int> index;
+  for (size_t i = 0;i < data.components.size();i++)index[data.components[i].id] = (int)i;
+  std::vector<Stimulus> stimulus;
+  if (!stimulusFile.empty() && !LoadStimulus(stimulusFile, index, stimulus))return 1;
+  std::stable_sort(stimulus.begin(), stimulus.end(), [](const Stimulus& a, const Stimulus& b) { return a.tick < b.tick; });
+
+  std::vector<int> bulbs;
+  for (size_t i = 0;i < nodes.size();i++) {
+    if (nodes[i].kind == NODE_SINK)bulbs.push_back((int)i);
+  }
+  // Clocks run at 1 Hz like a freshly inserted one unless told otherwise
+  std::vector<double> clockHertz(nodes.size(), 0.0);
+  for (size_t i = 0;i < nodes.size();i++) {
+    if (data.components[i].type == CODE_CLOCK)clockHertz[i] = 1.0;
+  }
+  for (const std::string& arg : clockArgs) {
+    size_t eq = arg.find('=');
+    auto it = index.find(arg.substr(0, eq));
+    if (eq == std::string::npos || it == index.end() || data.components[it->second].type != CODE_CLOCK
+      || !ParseNumber(std::string_view(arg).substr(eq + 1), clockHertz[it->second])) {
+      std::cerr << "Unknown clock " << arg << std::endl;
+      return 2;
+    }
+  }
+  ClockScheduler scheduler;
+  scheduler.Reset((int)nodes.size());
+  std::vector<unsigned char> sourceState(nodes.size(), 0);
+  for (int node : netlist.sources) {
+    sourceState[node] = nodes[node].state;
+    scheduler.SetClock(node, clockHertz[node], nodes[node].state);
+  }
+  if (eventDriven)netlist.ScheduleAll();
+
+  if (rate <= 0)rate = 1000.0;
+  SimTime period = (SimTime)(SIM_SECOND / rate);
+  if (period == 0)period = 1;
+  SimTime end = until >= 0 ? (SimTime)(until * SIM_SECOND) : (SimTime)ticks * period;
+  std::vector<int> toggled;
+  size_t next = 0;
+  std::vector<unsigned char> previous;
+  long long evaluations = 0;
+  bool settled = false;
+  auto start = std::chrono::steady_clock::now();
+  // Tick n covers the virtual time up to (n + 1) * period, with --until only the ticks holding an event are evaluated.
+  // A feedback loop still settling is not an event the scheduler knows of, those ticks are all evaluated.
+  for (long long tick = 0;(SimTime)tick * period < end;tick++) {
+    if (until >= 0 && settled) {
+      SimTime edge = scheduler.NextEdge();
+      long long edgeTick = edge == SIM_NEVER ? -1 : (long long)((edge + period - 1) / period) - 1;
+      long long stimulusTick = next < stimulus.size() ? stimulus[next].tick : -1;
+      long long jump = edgeTick < 0 ? stimulusTick : stimulusTick < 0 ? edgeTick : std::min(edgeTick, stimulusTick);
+      if (jump < 0 || (SimTime)jump * period >= end)break;
+      if (jump > tick)tick = jump;
+    }
+    toggled.clear();
+    scheduler.AdvanceTo((SimTime)(tick + 1) * period, toggled);
+    for (;next < stimulus.size() && stimulus[next].tick <= tick;next++) {
+      int node = stimulus[next].node;
+      if (nodes[node].kind != NODE_SOURCE)continue;
+      sourceState[node] = stimulus[next].value;
+      if (clockHertz[node] > 0)scheduler.SetClock(node, clockHertz[node], stimulus[next].value);
+    }
+    for (int node : netlist.sources) {
+      bool value = clockHertz[node] > 0 ? scheduler.GetState(node) : sourceState[node];
+      if (eventDriven)netlist.DriveSource(node, value);
+      else netlist.SetSource(node, value);
+    }
+    if (eventDriven) {
+      netlist.Propagate();
+      netlist.changed.clear();
+      settled = netlist.deferred.empty();
+    }
+    else if (until >= 0 && netlist.cyclic) {
+      // Feedback ops read last tick's nets, the loops are settled once a sweep leaves every net as it was
+      previous = netlist.values;
+      netlist.Evaluate();
+      settled = previous == netlist.values;
+    }
+    else {
+      netlist.Evaluate();
+      settled = true;
+    }
+    evaluations++;
+    if (trace) {
+      std::cout << tick << " ";
+      for (int bulb : bulbs)std::cout << netlist.GetState(bulb);
+      std::cout << "\n";
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  for (int bulb : bulbs)std::cout << data.components[bulb].id << "=" << netlist.GetState(bulb) << std::endl;
+  std::cerr << evaluations << " ticks of " << nodes.size() << " components in " << seconds << "s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,239 @@
+#include "BinaryFormat.hpp"
+#include "EditLog.hpp"
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+BoardView::BoardView() {
+  this->header = nullptr;
+  this->components = nullptr;
+  this->connections = nullptr;
+  this->heads = nullptr;
+  this->strings = nullptr;
+  this->stringBytes = nullptr;
+}
+static bool LittleEndianHost() {
+  uint32_t one = 1;
+  unsigned char first;
+  memcpy(&first, &one, 1);
+  return first == 1;
+}
+bool BoardView::Parse(const char* data, size_t size) {
+  if (!IsBinaryBoard(data, size))return false;
+  const BinaryHeader* header = (const BinaryHeader*)data;
+  if (header->version == 0 || header->version > BINARY_VERSION)return false;
+  // The tables are read in place, they have to be in the byte order of this host
+  if (header->byteOrder != BINARY_BYTE_ORDER && !(header->byteOrder == 0 && LittleEndianHost()))return false;
+  // 64 bit sums cannot overflow with 32 bit counts
+  uint64_t end = sizeof(BinaryHeader);
+  uint64_t components = end;
+  end += (uint64_t)header->componentCount * sizeof(BinaryComponent);
+  uint64_t connections = end;
+  end += (uint64_t)header->connectionCount * sizeof(BinaryConnection);
+  uint64_t heads = end;
+  end += (uint64_t)header->headCount * sizeof(uint32_t);
+  uint64_t strings = end;
+  end += (uint64_t)header->stringCount * sizeof(BinaryString);
+  uint64_t stringBytes = end;
+  end += header->stringBytes;
+  if (end > size)return false;
+  this->header = header;
+  this->components = (const BinaryComponent*)(data + components);
+  this->connections = (const BinaryConnection*)(data + connections);
+  this->heads = (const uint32_t*)(data + heads);
+  this->strings = (const BinaryString*)(data + strings);
+  this->stringBytes = data + stringBytes;
+  this->edits = std::string_view(data + end, size - end);
+  for (uint32_t i = 0;i < header->stringCount;i++) {
+    if ((uint64_t)this->strings[i].offset + this->strings[i].length > header->stringBytes)return false;
+  }
+  for (uint32_t i = 0;i < header->componentCount;i++) {
+    const BinaryComponent& comp = this->components[i];
+    if (comp.name >= header->stringCount || comp.type < CODE_SWITCH || comp.type > CODE_XOR)return false;
+    // The pin counts are fixed by the type, the loaders size their pin tables from them
+    int inputCount, outputCount;
+    PinCounts(comp.type, inputCount, outputCount);
+    if (comp.inputCount != inputCount || comp.outputCount != outputCount)return false;
+  }
+  for (uint32_t i = 0;i < header->connectionCount;i++) {
+    const BinaryConnection& conn = this->connections[i];
+    if (conn.to >= header->componentCount || conn.from >= header->componentCount)return false;
+  }
+  for (uint32_t i = 0;i < header->headCount;i++) {
+    if (this->heads[i] >= header->stringCount)return false;
+  }
+  return true;
+}
+std::string_view BoardView::String(uint32_t index) const {
+  return std::string_view(this->stringBytes + this->strings[index].offset, this->strings[index].length);
+}
+std::string_view BoardView::Name(uint32_t component) const {
+  return this->String(this->components[component].name);
+}
+
+bool IsBinaryBoard(const char* data, size_t size) {
+  return size >= sizeof(BinaryHeader) && memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+bool UsesBinaryFormat(const std::string& fileName) {
+  return fileName.size() >= 4 && fileName.compare(fileName.size() - 4, 4, ".gwb") == 0;
+}
+void ReadBinaryBoard(const BoardView& view, BoardData& data) {
+  data.components.clear();
+  data.connections.clear();
+  data.heads.clear();
+  data.components.reserve(view.header->componentCount);
+  for (uint32_t i = 0;i < view.header->componentCount;i++) {
+    const BinaryComponent& comp = view.components[i];
+    data.components.push_back({ std::string(view.Name(i)), comp.type, comp.x, comp.y, comp.inputCount, comp.outputCount, comp.state != 0 });
+  }
+  data.connections.reserve(view.header->connectionCount);
+  for (uint32_t i = 0;i < view.header->connectionCount;i++) {
+    const BinaryConnection& conn = view.connections[i];
+    data.connections.push_back({ std::string(view.Name(conn.to)), std::string(view.Name(conn.from)), conn.toPin, conn.fromPin });
+  }
+  for (uint32_t i = 0;i < view.header->headCount;i++)data.heads.push_back(std::string(view.String(view.heads[i])));
+  std::vector<EditOp> edits;
+  ReadEdits(view.edits, edits);
+  ApplyEdits(data, edits);
+}
+
+void WriteBoardText(BufferedWriter& out, const BoardView& view) {
+  const BinaryHeader& header = *view.header;
+  if (header.componentCount == 0)return;
+  // Components
+  for (uint32_t i = 0;i < header.componentCount;i++) {
+    const BinaryComponent& comp = view.components[i];
+    WriteComponentText(out, { view.Name(i), comp.type, comp.x, comp.y, comp.inputCount, comp.outputCount, comp.state != 0 });
+  }
+  out.Put('|');
+  // Connections, they are stored grouped by component in pin order and the pins in between are unconnected
+  uint32_t next = 0;
+  for (uint32_t i = 0;i < header.componentCount;i++) {
+    for (int pin = 0;pin < view.components[i].inputCount;pin++) {
+      const BinaryConnection* conn = next < header.connectionCount ? &view.connections[next] : nullptr;
+      if (conn && conn->to == i && conn->toPin == pin) {
+        WriteConnectionText(out, { view.Name(i), view.Name(conn->from), pin, conn->fromPin });
+        next++;
+      }
+      else WriteConnectionText(out, { view.Name(i), std::string_view(), pin, 0 });
+    }
+    while (next < header.connectionCount && view.connections[next].to == i)next++;
+  }
+  out.Put('|');
+  // Heads
+  for (uint32_t i = 0;i < header.headCount;i++) {
+    if (i > 0)out.Put(',');
+    out.Write(view.String(view.heads[i]));
+  }
+}
+
+void WriteBinaryBoard(BufferedWriter& out, BinaryBoardSource& source) {
+  // Component i is named by string i, heads reuse the name of their component and only unknown ones add strings
+  const std::vector<std::string>& heads = source.Heads();
+  std::unordered_map<std::string_view, uint32_t> names;
+  BinaryHeader header = {};
+  memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  header.version = BINARY_VERSION;
+  header.byteOrder = BINARY_BYTE_ORDER;
+  header.componentCount = source.ComponentCount();
+  header.headCount = (uint32_t)heads.size();
+  header.stringCount = header.componentCount;
+  names.reserve(header.componentCount);
+  for (uint32_t i = 0;i < header.componentCount;i++) {
+    std::string_view id = source.Id(i);
+    names.emplace(id, i);
+    header.stringBytes += (uint32_t)id.size();
+  }
+  BinaryConnection conn;
+  source.StartConnections();
+  while (source.NextConnection(conn))header.connectionCount++;
+  for (const std::string& head : heads) {
+    if (names.count(head))continue;
+    header.stringCount++;
+    header.stringBytes += (uint32_t)head.size();
+  }
+  out.Write(&header, sizeof(BinaryHeader));
+  for (uint32_t i = 0;i < header.componentCount;i++) {
+    BinaryComponent comp = {};
+    source.GetComponent(i, comp);
+    comp.name = i;
+    out.Write(&comp, sizeof(BinaryComponent));
+  }
+  source.StartConnections();
+  while (source.NextConnection(conn))out.Write(&conn, sizeof(BinaryConnection));
+  uint32_t extra = header.componentCount;
+  for (const std::string& head : heads) {
+    auto it = names.find(head);
+    uint32_t name = it != names.end() ? it->second : extra++;
+    out.Write(&name, sizeof(uint32_t));
+  }
+  BinaryString entry = { 0, 0 };
+  for (uint32_t i = 0;i < header.componentCount;i++) {
+    entry.length = (uint32_t)source.Id(i).size();
+    out.Write(&entry, sizeof(BinaryString));
+    entry.offset += entry.length;
+  }
+  for (const std::string& head : heads) {
+    if (names.count(head))continue;
+    entry.length = (uint32_t)head.size();
+    out.Write(&entry, sizeof(BinaryString));
+    entry.offset += entry.length;
+  }
+  for (uint32_t i = 0;i < header.componentCount;i++)out.Write(source.Id(i));
+  for (const std::string& head : heads) {
+    if (!names.count(head))out.Write(head);
+  }
+}
+
+// Records of a BoardData, only the connected pins between known components are stored
+class BoardDataSource :public BinaryBoardSource {
+public:
+  const BoardData* data;
+  std::unordered_map<std::string_view, uint32_t> index;
+  size_t next;
+  BoardDataSource(const BoardData* data) {
+    this->data = data;
+    this->next = 0;
+    this->index.reserve(data->components.size());
+    for (size_t i = 0;i < data->components.size();i++)this->index.emplace(data->components[i].id, (uint32_t)i);
+  }
+  uint32_t ComponentCount() override {
+    return (uint32_t)this->data->components.size();
+  }
+  std::string_view Id(uint32_t component) override {
+    return this->data->components[component].id;
+  }
+  void GetComponent(uint32_t component, BinaryComponent& comp) override {
+    const ComponentRecord& record = this->data->components[component];
+    comp.x = record.x;
+    comp.y = record.y;
+    comp.inputCount = (uint16_t)record.inputCount;
+    comp.outputCount = (uint16_t)record.outputCount;
+    comp.type = (uint8_t)record.type;
+    comp.state = record.state;
+  }
+  void StartConnections() override {
+    this->next = 0;
+  }
+  bool NextConnection(BinaryConnection& conn) override {
+    while (this->next < this->data->connections.size()) {
+      const ConnectionRecord& record = this->data->connections[this->next++];
+      if (record.from.empty())continue;
+      auto to = this->index.find(record.to);
+      auto from = this->index.find(record.from);
+      if (to == this->index.end() || from == this->index.end())continue;
+      conn = { to->second, from->second, (uint16_t)record.toPin, (uint16_t)record.fromPin };
+      return true;
+    }
+    return false;
+  }
+  const std::vector<std::string>& Heads() override {
+    return this->data->heads;
+  }
+};
+
+void WriteBinaryBoard(BufferedWriter& out, const BoardData& data) {
+  BoardDataSource source(&data);
+  WriteBinaryBoard(out, source);
+}
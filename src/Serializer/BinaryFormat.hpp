@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Serializer.hpp"
+
+// Binary board files (*.gwb) are a header followed by packed tables in the byte order of the writer (little endian
+// on every supported platform), each one 4 byte aligned:
+//   BinaryHeader | BinaryComponent[componentCount] | BinaryConnection[connectionCount] | uint32_t[headCount]
+//   | BinaryString[stringCount] | stringBytes bytes of text | EditLog records
+// Components refer to each other by their index in the component table, the ids only live in the string table.
+// Delta saves append the edits since the full snapshot as text records after the string bytes.
+static const char BINARY_MAGIC[4] = { 'G', 'W', 'B', 'F' };
+static const uint32_t BINARY_VERSION = 1;
+static const uint32_t BINARY_BYTE_ORDER = 0x01020304; // Reads back as 0x04030201 on a host of the other byte order
+
+typedef struct BinaryHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t componentCount;
+  uint32_t connectionCount;
+  uint32_t headCount;
+  uint32_t stringCount;
+  uint32_t stringBytes;
+  uint32_t byteOrder; // BINARY_BYTE_ORDER, 0 in files written before it was stored, those are little endian
+}BinaryHeader;
+
+typedef struct BinaryComponent {
+  uint32_t name; // Index into the string table
+  float x, y;
+  uint16_t inputCount;
+  uint16_t outputCount;
+  uint8_t type;  // ComponentCode
+  uint8_t state;
+  uint8_t padding[2];
+}BinaryComponent;
+
+// Only connected input pins are stored
+typedef struct BinaryConnection {
+  uint32_t to;   // Component index
+  uint32_t from; // Component index
+  uint16_t toPin;
+  uint16_t fromPin;
+}BinaryConnection;
+
+typedef struct BinaryString {
+  uint32_t offset; // Into the string bytes
+  uint32_t length;
+}BinaryString;
+
+static_assert(sizeof(BinaryHeader) == 32 && sizeof(BinaryComponent) == 20 && sizeof(BinaryConnection) == 12 && sizeof(BinaryString) == 8,
+  "the binary board tables must stay packed");
+
+// Zero copy view of a binary board held in memory (usually a MappedFile), the tables point straight into the bytes
+class BoardView {
+public:
+  const BinaryHeader* header;
+  const BinaryComponent* components;
+  const BinaryConnection* connections;
+  const uint32_t* heads;
+  const BinaryString* strings;
+  const char* stringBytes;
+  std::string_view edits; // Everything after the string bytes
+  BoardView();
+  // Checks the header and every index once so the accessors can trust the tables afterwards
+  bool Parse(const char* data, size_t size);
+  std::string_view String(uint32_t index) const;
+  std::string_view Name(uint32_t component) const;
+};
+
+bool IsBinaryBoard(const char* data, size_t size);
+bool UsesBinaryFormat(const std::string& fileName); // Decided by the .gwb extension when saving
+void ReadBinaryBoard(const BoardView& view, BoardData& data); // Appended edits included
+// Text format of the snapshot part of a binary board, one connection record per input pin like Board::SaveBoard always wrote
+void WriteBoardText(BufferedWriter& out, const BoardView& view);
+
+// What WriteBinaryBoard reads a board from, component i becomes entry i of the component table and of the string table
+class BinaryBoardSource {
+public:
+  virtual ~BinaryBoardSource() {}
+  virtual uint32_t ComponentCount() = 0;
+  virtual std::string_view Id(uint32_t component) = 0;
+  virtual void GetComponent(uint32_t component, BinaryComponent& comp) = 0; // Everything but the name
+  // Connected input pins in table order, the writer rewinds once to count them before writing them
+  virtual void StartConnections() = 0;
+  virtual bool NextConnection(BinaryConnection& conn) = 0;
+  virtual const std::vector<std::string>& Heads() = 0;
+};
+
+void WriteBinaryBoard(BufferedWriter& out, BinaryBoardSource& source);
+void WriteBinaryBoard(BufferedWriter& out, const BoardData& data);
@@ -0,0 +1,117 @@
+#include "BoardSaver.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <utility>
+#include "BinaryFormat.hpp"
+#include "BufferedWriter.hpp"
+
+BoardSaver::BoardSaver() {
+  this->busy = false;
+  this->stopping = false;
+}
+BoardSaver::~BoardSaver() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->wake.notify_one();
+  if (this->worker.joinable())this->worker.join();
+}
+void BoardSaver::SaveBoard(const std::string& fileName, std::string image, bool compress, std::vector<std::string> discard) {
+  this->Queue({ SAVE_BOARD, fileName, std::move(image), {}, std::move(discard), false, compress });
+}
+void BoardSaver::SaveDelta(const std::string& fileName, std::vector<EditOp> edits, bool openSection, std::vector<std::string> discard) {
+  this->Queue({ SAVE_DELTA, fileName, "", std::move(edits), std::move(discard), openSection, false });
+}
+void BoardSaver::AppendJournal(const std::string& fileName, std::vector<EditOp> edits) {
+  this->Queue({ SAVE_JOURNAL, fileName, "", std::move(edits), {}, false, false });
+}
+void BoardSaver::Discard(const std::string& fileName) {
+  this->Queue({ SAVE_DISCARD, fileName, "", {}, {}, false, false });
+}
+void BoardSaver::Queue(SaveJob job) {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->jobs.push_back(std::move(job));
+    // The thread only exists once there is something to write
+    if (!this->worker.joinable())this->worker = std::thread(&BoardSaver::Run, this);
+  }
+  this->wake.notify_one();
+}
+bool BoardSaver::PollResult(SaveResult& result) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->results.empty())return false;
+  result = std::move(this->results.front());
+  this->results.erase(this->results.begin());
+  return true;
+}
+void BoardSaver::Wait() {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->idle.wait(lock, [this] { return this->jobs.empty() && !this->busy; });
+}
+void BoardSaver::Run() {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true) {
+    this->wake.wait(lock, [this] { return this->stopping || !this->jobs.empty(); });
+    if (this->jobs.empty())break; // Stopping and nothing left to write
+    SaveJob job = std::move(this->jobs.front());
+    this->jobs.pop_front();
+    this->busy = true;
+    lock.unlock();
+    bool success = true;
+    if (job.kind == SAVE_BOARD || job.kind == SAVE_DELTA) {
+      auto failed = std::find(this->failedBoards.begin(), this->failedBoards.end(), job.fileName);
+      if (job.kind == SAVE_BOARD)success = WriteBoardImage(job.fileName, job.image, job.compress);
+      else success = failed == this->failedBoards.end() && AppendDelta(job.fileName, job.edits, job.openSection);
+      // The file on disk no longer matches the board, only a full save can fix it
+      if (!success && failed == this->failedBoards.end())this->failedBoards.push_back(job.fileName);
+      if (success && failed != this->failedBoards.end())this->failedBoards.erase(failed);
+      if (success)for (const std::string& fileName : job.discard)std::remove(fileName.c_str());
+    }
+    else if (job.kind == SAVE_JOURNAL)AppendEdits(job.fileName, job.edits);
+    else std::remove(job.fileName.c_str());
+    lock.lock();
+    if (job.kind == SAVE_BOARD || job.kind == SAVE_DELTA)this->results.push_back({ job.fileName, success });
+    this->busy = false;
+    this->idle.notify_all();
+  }
+}
+
+bool WriteBoardImage(const std::string& fileName, const std::string& image, bool compress) {
+  BoardView view;
+  if (!view.Parse(image.data(), image.size()))return false;
+  // A crash half way through leaves the previous save untouched
+  std::string temporary = fileName + ".tmp";
+  BufferedWriter out;
+  if (!out.Open(temporary))return false;
+  if (compress)out.Compress();
+  if (UsesBinaryFormat(fileName))out.Write(image);
+  else WriteBoardText(out, view);
+  if (!out.Close()) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, fileName, error);
+  return !error;
+}
+bool AppendEdits(const std::string& fileName, const std::vector<EditOp>& edits) {
+  BufferedWriter out;
+  if (!out.Open(fileName, true))return false;
+  for (const EditOp& op : edits)WriteEditText(out, op);
+  return out.Close();
+}
+bool AppendDelta(const std::string& fileName, const std::vector<EditOp>& edits, bool openSection) {
+  // Appending to a file that is gone would leave the edits without their snapshot
+  std::FILE* existing = std::fopen(fileName.c_str(), "rb");
+  if (existing == nullptr)return false;
+  std::fclose(existing);
+  // Nothing to append, the edit section is only opened together with its first edit
+  if (edits.empty())return true;
+  BufferedWriter out;
+  if (!out.Open(fileName, true))return false;
+  if (openSection)out.Put('|');
+  for (const EditOp& op : edits)WriteEditText(out, op);
+  return out.Close();
+}
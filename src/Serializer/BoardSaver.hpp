@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EditLog.hpp"
+
+typedef enum SaveJobKind {
+  SAVE_BOARD,   // Write image to fileName (text or binary by extension, compressed or not), then remove the discard files
+  SAVE_DELTA,   // Append edits to the board file fileName, then remove the discard files
+  SAVE_JOURNAL, // Append edits to the journal fileName
+  SAVE_DISCARD  // Remove fileName
+}SaveJobKind;
+
+typedef struct SaveJob {
+  SaveJobKind kind;
+  std::string fileName;
+  std::string image;                // Binary board image (see BinaryFormat.hpp) captured on the UI thread
+  std::vector<EditOp> edits;
+  std::vector<std::string> discard; // Journals made obsolete by a successful SAVE_BOARD or SAVE_DELTA
+  bool openSection;                 // SAVE_DELTA on a text board without edits yet, the edit section starts first
+  bool compress;                    // SAVE_BOARD writes a compressed board
+}SaveJob;
+
+typedef struct SaveResult {
+  std::string fileName;
+  bool success;
+}SaveResult;
+
+// Writes board files and journals on its own thread, strictly in the order the jobs were queued.
+// Board files go to a temporary file first and replace the old one only when completely written.
+class BoardSaver {
+public:
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  std::deque<SaveJob> jobs;
+  std::vector<SaveResult> results;
+  bool busy;
+  bool stopping;
+  std::vector<std::string> failedBoards; // Only touched by the worker, deltas on top of a failed save are refused
+  BoardSaver();
+  ~BoardSaver(); // Finishes every queued job first
+  void SaveBoard(const std::string& fileName, std::string image, bool compress, std::vector<std::string> discard);
+  void SaveDelta(const std::string& fileName, std::vector<EditOp> edits, bool openSection, std::vector<std::string> discard);
+  void AppendJournal(const std::string& fileName, std::vector<EditOp> edits);
+  void Discard(const std::string& fileName);
+  bool PollResult(SaveResult& result); // Outcome of a finished SAVE_BOARD or SAVE_DELTA, false when there is none
+  void Wait();                          // Blocks until every queued job is done
+  void Queue(SaveJob job);
+  void Run();
+};
+
+// Board file writers used by the saver, both return false if anything failed
+bool WriteBoardImage(const std::string& fileName, const std::string& image, bool compress);
+bool AppendEdits(const std::string& fileName, const std::vector<EditOp>& edits);
+bool AppendDelta(const std::string& fileName, const std::vector<EditOp>& edits, bool openSection); // The board file must exist
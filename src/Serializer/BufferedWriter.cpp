@@ -0,0 +1,95 @@
+#include "BufferedWriter.hpp"
+#include "Compression.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+BufferedWriter::BufferedWriter(std::string* target) {
+  this->file = nullptr;
+  this->target = target;
+  this->buffer.resize(BUFFER_SIZE);
+  this->used = 0;
+  this->failed = false;
+  this->compress = false;
+}
+BufferedWriter::~BufferedWriter() {
+  this->Close();
+}
+bool BufferedWriter::Open(const std::string& fileName, bool append) {
+  this->Close();
+  this->file = std::fopen(fileName.c_str(), append ? "ab" : "wb");
+  this->failed = this->file == nullptr;
+  return !this->failed;
+}
+bool BufferedWriter::Close() {
+  this->Flush();
+  if (this->compress) {
+    CompressedBlock end = { 0, 0 };
+    this->Emit(&end, sizeof(end));
+    this->compress = false;
+  }
+  if (this->file) {
+    if (std::fclose(this->file) != 0)this->failed = true;
+    this->file = nullptr;
+  }
+  return !this->failed;
+}
+void BufferedWriter::Flush() {
+  if (this->used == 0)return;
+  if (this->compress) {
+    // The buffer is exactly one block, it is kept as is if compressing does not make it smaller
+    static_assert(BUFFER_SIZE <= COMPRESSED_BLOCK_SIZE, "A full buffer has to fit in one block");
+    this->packed.resize(sizeof(CompressedBlock) + CompressBound(BUFFER_SIZE));
+    char* payload = this->packed.data() + sizeof(CompressedBlock);
+    size_t size = CompressBlock(this->buffer.data(), this->used, payload, this->packed.size() - sizeof(CompressedBlock));
+    CompressedBlock block = { (uint32_t)size, (uint32_t)this->used };
+    if (size == 0 || size >= this->used) {
+      memcpy(payload, this->buffer.data(), this->used);
+      block.size = (uint32_t)this->used | BLOCK_STORED;
+      size = this->used;
+    }
+    memcpy(this->packed.data(), &block, sizeof(block));
+    this->Emit(this->packed.data(), sizeof(CompressedBlock) + size);
+  }
+  else this->Emit(this->buffer.data(), this->used);
+  this->used = 0;
+}
+void BufferedWriter::Compress() {
+  this->Flush();
+  CompressedHeader header = { { COMPRESSED_MAGIC[0], COMPRESSED_MAGIC[1], COMPRESSED_MAGIC[2], COMPRESSED_MAGIC[3] }, COMPRESSED_VERSION };
+  this->Emit(&header, sizeof(header));
+  this->compress = true;
+}
+void BufferedWriter::Emit(const void* data, size_t size) {
+  if (this->target)this->target->append((const char*)data, size);
+  else if (!this->file || std::fwrite(data, 1, size, this->file) != size)this->failed = true;
+}
+void BufferedWriter::Write(const void* data, size_t size) {
+  const char* bytes = (const char*)data;
+  while (size > 0) {
+    if (this->used == BUFFER_SIZE)this->Flush();
+    size_t chunk = std::min(size, BUFFER_SIZE - this->used);
+    memcpy(this->buffer.data() + this->used, bytes, chunk);
+    this->used += chunk;
+    bytes += chunk;
+    size -= chunk;
+  }
+}
+void BufferedWriter::Write(std::string_view text) {
+  this->Write(text.data(), text.size());
+}
+void BufferedWriter::Put(char c) {
+  if (this->used == BUFFER_SIZE)this->Flush();
+  this->buffer[this->used++] = c;
+}
+void BufferedWriter::WriteInt(long long value) {
+  // 20 digits and a sign always fit
+  if (BUFFER_SIZE - this->used < 24)this->Flush();
+  char* start = this->buffer.data() + this->used;
+  this->used += std::to_chars(start, this->buffer.data() + BUFFER_SIZE, value).ptr - start;
+}
+void BufferedWriter::WriteFloat(float value) {
+  if (BUFFER_SIZE - this->used < 64)this->Flush();
+  char* start = this->buffer.data() + this->used;
+  this->used += std::to_chars(start, this->buffer.data() + BUFFER_SIZE, value).ptr - start;
+}
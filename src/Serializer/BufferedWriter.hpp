@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streams bytes into a file through one fixed size buffer, or into a string when target is set.
+// Numbers are formatted in place with std::to_chars so writing a board never builds temporary strings.
+// After Compress every full buffer goes out as one block of a compressed board (see Compression.hpp).
+class BufferedWriter {
+public:
+  static const size_t BUFFER_SIZE = 1 << 16;
+  std::FILE* file;
+  std::string* target;
+  std::vector<char> buffer;
+  size_t used;
+  bool failed;
+  bool compress;
+  std::vector<char> packed; // Compressed block on its way out
+  BufferedWriter(std::string* target = nullptr);
+  ~BufferedWriter();
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+  bool Open(const std::string& fileName, bool append = false);
+  bool Close(); // Flushes and closes the file, false if anything failed on the way
+  void Flush();
+  void Compress(); // Everything written from now until Close is compressed
+  void Emit(const void* data, size_t size);
+  void Write(const void* data, size_t size);
+  void Write(std::string_view text);
+  void Put(char c);
+  void WriteInt(long long value);
+  void WriteFloat(float value); // Shortest text that reads back to the same float
+};
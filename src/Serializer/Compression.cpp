@@ -0,0 +1,162 @@
+#include "Compression.hpp"
+#include <cstring>
+#include <vector>
+
+// LZ4 block format: sequences of a token (literal count << 4 | match length - 4), the literals, a 2 byte little
+// endian offset and the match. Counts of 15 and more continue in the following bytes, 255 at a time. The last
+// sequence only has literals, it covers at least the last LAST_LITERALS bytes and no match starts in the last MATCH_LIMIT.
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;
+static const size_t MATCH_LIMIT = 12;
+static const int HASH_LOG = 13;
+
+static uint32_t Read32(const unsigned char* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+static uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+static unsigned char* WriteLength(unsigned char* out, size_t length) {
+  for (;length >= 255;length -= 255)*out++ = 255;
+  *out++ = (unsigned char)length;
+  return out;
+}
+// Appends one sequence, a match length of 0 makes it the closing literals only sequence
+static unsigned char* WriteSequence(unsigned char* out, const unsigned char* end, const unsigned char* literals, size_t literalCount, size_t offset, size_t matchLength) {
+  size_t needed = 1 + literalCount / 255 + 1 + literalCount + (matchLength ? 2 + matchLength / 255 + 1 : 0);
+  if ((size_t)(end - out) < needed)return nullptr;
+  size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+  *out++ = (unsigned char)((literalCount < 15 ? literalCount : 15) << 4 | (matchCode < 15 ? matchCode : 15));
+  if (literalCount >= 15)out = WriteLength(out, literalCount - 15);
+  memcpy(out, literals, literalCount);
+  out += literalCount;
+  if (matchLength == 0)return out;
+  *out++ = (unsigned char)(offset & 0xff);
+  *out++ = (unsigned char)(offset >> 8);
+  if (matchCode >= 15)out = WriteLength(out, matchCode - 15);
+  return out;
+}
+
+size_t CompressBlock(const char* data, size_t size, char* out, size_t capacity) {
+  if (size > COMPRESSED_BLOCK_SIZE)return 0;
+  const unsigned char* in = (const unsigned char*)data;
+  unsigned char* dst = (unsigned char*)out;
+  const unsigned char* dstEnd = dst + capacity;
+  // Blocks are at most 64 KiB, 16 bit positions are enough
+  uint16_t table[1 << HASH_LOG] = {};
+  size_t anchor = 0, pos = 1;
+  if (size > MATCH_LIMIT) {
+    size_t limit = size - MATCH_LIMIT, matchEnd = size - LAST_LITERALS;
+    table[Hash(Read32(in))] = 0;
+    while (pos < limit) {
+      uint32_t sequence = Read32(in + pos);
+      uint32_t hash = Hash(sequence);
+      size_t candidate = table[hash];
+      table[hash] = (uint16_t)pos;
+      if (candidate >= pos || Read32(in + candidate) != sequence) {
+        // Step faster through data that does not repeat
+        pos += 1 + ((pos - anchor) >> 6);
+        continue;
+      }
+      size_t length = MIN_MATCH;
+      while (pos + length < matchEnd && in[candidate + length] == in[pos + length])length++;
+      while (pos > anchor && candidate > 0 && in[pos - 1] == in[candidate - 1]) {
+        pos--;
+        candidate--;
+        length++;
+      }
+      dst = WriteSequence(dst, dstEnd, in + anchor, pos - anchor, pos - candidate, length);
+      if (dst == nullptr)return 0;
+      pos += length;
+      anchor = pos;
+      if (pos - 2 < limit)table[Hash(Read32(in + pos - 2))] = (uint16_t)(pos - 2);
+    }
+  }
+  dst = WriteSequence(dst, dstEnd, in + anchor, size - anchor, 0, 0);
+  return dst == nullptr ? 0 : dst - (unsigned char*)out;
+}
+
+static bool ReadLength(const unsigned char*& in, const unsigned char* end, size_t limit, size_t& length) {
+  unsigned char byte;
+  do {
+    if (in == end || length > limit)return false;
+    byte = *in++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+bool DecompressBlock(const char* data, size_t size, char* out, size_t rawSize) {
+  const unsigned char* in = (const unsigned char*)data;
+  const unsigned char* end = in + size;
+  unsigned char* dst = (unsigned char*)out;
+  unsigned char* dstEnd = dst + rawSize;
+  while (in < end) {
+    unsigned char token = *in++;
+    size_t literals = token >> 4;
+    if (literals == 15 && !ReadLength(in, end, rawSize, literals))return false;
+    if (literals > (size_t)(end - in) || literals > (size_t)(dstEnd - dst))return false;
+    memcpy(dst, in, literals);
+    in += literals;
+    dst += literals;
+    if (in == end)break;
+    if (end - in < 2)return false;
+    size_t offset = in[0] | (size_t)in[1] << 8;
+    in += 2;
+    if (offset == 0 || offset > (size_t)(dst - (unsigned char*)out))return false;
+    size_t length = token & 15;
+    if (length == 15 && !ReadLength(in, end, rawSize, length))return false;
+    length += MIN_MATCH;
+    if (length > (size_t)(dstEnd - dst))return false;
+    const unsigned char* match = dst - offset;
+    // Overlapping matches repeat the bytes they are still writing
+    if (offset >= length)memcpy(dst, match, length);
+    else for (size_t i = 0;i < length;i++)dst[i] = match[i];
+    dst += length;
+  }
+  return dst == dstEnd;
+}
+
+bool IsCompressedBoard(const char* data, size_t size) {
+  return size >= sizeof(CompressedHeader) && memcmp(data, COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC)) == 0;
+}
+bool UnpackBoard(const char* data, size_t size, std::string& buffer, std::string_view& bytes) {
+  if (!IsCompressedBoard(data, size)) {
+    bytes = std::string_view(data, size);
+    return true;
+  }
+  CompressedHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.version == 0 || header.version > COMPRESSED_VERSION)return false;
+  // Walk the block headers first so the board is decompressed into a buffer of the right size
+  std::vector<size_t> blocks;
+  size_t pos = sizeof(CompressedHeader), rawSize = 0;
+  CompressedBlock block;
+  while (true) {
+    if (size - pos < sizeof(CompressedBlock))return false;
+    memcpy(&block, data + pos, sizeof(block));
+    if (block.size == 0)break;
+    size_t stored = block.size & ~BLOCK_STORED;
+    if (block.rawSize > COMPRESSED_BLOCK_SIZE || stored > CompressBound(block.rawSize) || stored > size - pos - sizeof(CompressedBlock))return false;
+    if ((block.size & BLOCK_STORED) && stored != block.rawSize)return false;
+    blocks.push_back(pos);
+    rawSize += block.rawSize;
+    // Nothing is allocated for sizes the file could not possibly decode to
+    if (rawSize > size * MAX_EXPANSION)return false;
+    pos += sizeof(CompressedBlock) + stored;
+  }
+  size_t trailer = pos + sizeof(CompressedBlock);
+  buffer.resize(rawSize + (size - trailer));
+  char* out = buffer.data();
+  for (size_t start : blocks) {
+    memcpy(&block, data + start, sizeof(block));
+    const char* payload = data + start + sizeof(CompressedBlock);
+    if (block.size & BLOCK_STORED)memcpy(out, payload, block.rawSize);
+    else if (!DecompressBlock(payload, block.size, out, block.rawSize))return false;
+    out += block.rawSize;
+  }
+  memcpy(out, data + trailer, size - trailer);
+  bytes = buffer;
+  return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Compressed board files wrap the bytes of a text or binary board:
+//   CompressedHeader | { CompressedBlock, block bytes }... | CompressedBlock of size 0 | appended bytes
+// Every block holds at most COMPRESSED_BLOCK_SIZE bytes of the board in the LZ4 block format, or stored as they are
+// when they do not shrink. Delta saves append their edits uncompressed after the end block, they follow the
+// decompressed board.
+static const char COMPRESSED_MAGIC[4] = { 'G', 'W', 'B', 'Z' };
+static const uint32_t COMPRESSED_VERSION = 1;
+static const uint32_t COMPRESSED_BLOCK_SIZE = 1 << 16; // Also the reach of the 16 bit match offsets
+static const uint32_t BLOCK_STORED = 1u << 31;         // Flag in CompressedBlock::size
+static const size_t MAX_EXPANSION = 256;               // LZ4 never decodes one byte into more than 255
+
+typedef struct CompressedHeader {
+  char magic[4];
+  uint32_t version;
+}CompressedHeader;
+
+typedef struct CompressedBlock {
+  uint32_t size;    // Bytes that follow, BLOCK_STORED set when they are not compressed
+  uint32_t rawSize; // Bytes of the board they stand for
+}CompressedBlock;
+
+static_assert(sizeof(CompressedHeader) == 8, "CompressedHeader is part of the file format");
+static_assert(sizeof(CompressedBlock) == 8, "CompressedBlock is part of the file format");
+
+// Worst case size of a compressed block of size bytes
+constexpr size_t CompressBound(size_t size) {
+  return size + size / 255 + 16;
+}
+// LZ4 block of at most COMPRESSED_BLOCK_SIZE bytes, 0 if it does not fit in capacity
+size_t CompressBlock(const char* data, size_t size, char* out, size_t capacity);
+// Fails on anything that does not decode to exactly rawSize bytes
+bool DecompressBlock(const char* data, size_t size, char* out, size_t rawSize);
+
+bool IsCompressedBoard(const char* data, size_t size);
+// Bytes of the board in a file, decompressed into buffer for compressed files and the file itself otherwise
+bool UnpackBoard(const char* data, size_t size, std::string& buffer, std::string_view& bytes);
@@ -0,0 +1,175 @@
+#include "EditLog.hpp"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+void WriteEditText(BufferedWriter& out, const EditOp& op) {
+  out.Put((char)op.kind);
+  out.Put(',');
+  out.Write(op.id);
+  switch (op.kind) {
+  case EDIT_INSERT:
+    out.Put(',');
+    out.WriteInt(op.type);
+    out.Put(',');
+    out.WriteFloat(op.x);
+    out.Put(',');
+    out.WriteFloat(op.y);
+    break;
+  case EDIT_MOVE:
+    out.Put(',');
+    out.WriteFloat(op.x);
+    out.Put(',');
+    out.WriteFloat(op.y);
+    break;
+  case EDIT_CONNECT:
+    out.Put(',');
+    out.WriteInt(op.pin);
+    out.Put(',');
+    out.Write(op.from);
+    out.Put(',');
+    out.WriteInt(op.fromPin);
+    break;
+  case EDIT_DISCONNECT:
+    out.Put(',');
+    out.WriteInt(op.pin);
+    break;
+  case EDIT_STATE:
+    out.Put(',');
+    out.Put(op.type ? '1' : '0');
+    break;
+  case EDIT_DELETE:
+    break;
+  }
+  out.Put(';');
+}
+
+void ReadEdits(std::string_view text, std::vector<EditOp>& ops) {
+  TextBoardParser parser(text);
+  std::string_view fields[5];
+  while (true) {
+    int count = parser.NextRecord(fields, 5);
+    if (count < 2 || fields[0].size() != 1)return;
+    EditOp op = {};
+    op.kind = (EditKind)fields[0][0];
+    op.id.assign(fields[1]);
+    bool valid = false;
+    switch (op.kind) {
+    case EDIT_INSERT:
+      valid = count >= 5 && ParseNumber(fields[2], op.type) && ParseNumber(fields[3], op.x) && ParseNumber(fields[4], op.y);
+      break;
+    case EDIT_DELETE:
+      valid = true;
+      break;
+    case EDIT_MOVE:
+      valid = count >= 4 && ParseNumber(fields[2], op.x) && ParseNumber(fields[3], op.y);
+      break;
+    case EDIT_CONNECT:
+      valid = count >= 5 && ParseNumber(fields[2], op.pin) && ParseNumber(fields[4], op.fromPin);
+      if (valid)op.from.assign(fields[3]);
+      break;
+    case EDIT_DISCONNECT:
+      valid = count >= 3 && ParseNumber(fields[2], op.pin);
+      break;
+    case EDIT_STATE:
+      valid = count >= 3;
+      op.type = valid && fields[2] == "1";
+      break;
+    }
+    if (!valid)return;
+    ops.push_back(std::move(op));
+  }
+}
+
+// Heads are the components nothing reads from, Board rebuilds them like this after every disconnect or delete
+static void RebuildHeads(BoardData& data, const std::vector<unsigned char>& dropped) {
+  std::unordered_set<std::string_view> drivers;
+  for (size_t i = 0;i < data.connections.size();i++) {
+    if (!dropped[i] && !data.connections[i].from.empty())drivers.insert(data.connections[i].from);
+  }
+  data.heads.clear();
+  for (const ComponentRecord& comp : data.components) {
+    if (!drivers.count(comp.id))data.heads.push_back(comp.id);
+  }
+}
+
+void ApplyEdits(BoardData& data, const std::vector<EditOp>& ops) {
+  if (ops.empty())return;
+  // Components are swap-removed like on the board, connection records are only flagged so their indices stay valid
+  std::unordered_map<std::string, size_t> components;
+  std::unordered_map<std::string, size_t> pins; // "to,pin" of every connection record
+  std::vector<unsigned char> dropped(data.connections.size(), 0);
+  for (size_t i = 0;i < data.components.size();i++)components[data.components[i].id] = i;
+  for (size_t i = 0;i < data.connections.size();i++) {
+    pins[data.connections[i].to + "," + std::to_string(data.connections[i].toPin)] = i;
+  }
+  for (const EditOp& op : ops) {
+    auto it = components.find(op.id);
+    if (op.kind == EDIT_INSERT) {
+      if (it != components.end() || op.type < CODE_SWITCH || op.type > CODE_XOR)continue;
+      ComponentRecord record = { op.id, op.type, op.x, op.y, 0, 0, false };
+      PinCounts(op.type, record.inputCount, record.outputCount);
+      components[op.id] = data.components.size();
+      data.components.push_back(record);
+      data.heads.push_back(op.id);
+      continue;
+    }
+    if (it == components.end())continue;
+    ComponentRecord& comp = data.components[it->second];
+    if (op.kind == EDIT_DELETE) {
+      for (size_t i = 0;i < data.connections.size();i++) {
+        ConnectionRecord& conn = data.connections[i];
+        if (dropped[i])continue;
+        if (conn.to == op.id) {
+          dropped[i] = 1;
+          pins.erase(conn.to + "," + std::to_string(conn.toPin));
+        }
+        else if (conn.from == op.id)conn.from.clear();
+      }
+      size_t index = it->second;
+      components.erase(it);
+      if (index + 1 < data.components.size()) {
+        data.components[index] = std::move(data.components.back());
+        components[data.components[index].id] = index;
+      }
+      data.components.pop_back();
+      RebuildHeads(data, dropped);
+    }
+    else if (op.kind == EDIT_MOVE) {
+      comp.x = op.x;
+      comp.y = op.y;
+    }
+    else if (op.kind == EDIT_STATE)comp.state = op.type != 0;
+    else if (op.kind == EDIT_CONNECT) {
+      auto from = components.find(op.from);
+      if (from == components.end() || op.pin < 0 || op.pin >= comp.inputCount)continue;
+      if (op.fromPin < 0 || op.fromPin >= data.components[from->second].outputCount)continue;
+      std::string key = op.id + "," + std::to_string(op.pin);
+      auto pin = pins.find(key);
+      if (pin == pins.end()) {
+        pins[key] = data.connections.size();
+        data.connections.push_back({ op.id, op.from, op.pin, op.fromPin });
+        dropped.push_back(0);
+      }
+      else if (data.connections[pin->second].from.empty()) {
+        data.connections[pin->second].from = op.from;
+        data.connections[pin->second].fromPin = op.fromPin;
+      }
+      else continue; // The pin is taken, Board refuses the connection as well
+      data.heads.erase(std::remove(data.heads.begin(), data.heads.end(), op.from), data.heads.end());
+    }
+    else if (op.kind == EDIT_DISCONNECT) {
+      auto pin = pins.find(op.id + "," + std::to_string(op.pin));
+      if (pin != pins.end())data.connections[pin->second].from.clear();
+      RebuildHeads(data, dropped);
+    }
+  }
+  size_t kept = 0;
+  for (size_t i = 0;i < data.connections.size();i++) {
+    if (dropped[i])continue;
+    if (kept != i)data.connections[kept] = std::move(data.connections[i]);
+    kept++;
+  }
+  data.connections.resize(kept);
+}
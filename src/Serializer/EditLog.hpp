@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BufferedWriter.hpp"
+#include "Serializer.hpp"
+
+// Kinds of board edits, the letter is the first field of the record in a journal
+typedef enum EditKind {
+  EDIT_INSERT = 'I',     // I,id,type,x,y;
+  EDIT_DELETE = 'D',     // D,id;
+  EDIT_MOVE = 'M',       // M,id,x,y;
+  EDIT_CONNECT = 'C',    // C,to,toPin,from,fromPin;
+  EDIT_DISCONNECT = 'X', // X,to,toPin;
+  EDIT_STATE = 'S'       // S,id,state;
+}EditKind;
+
+// One edit of a board, components are named by their ids like in the save files
+typedef struct EditOp {
+  EditKind kind;
+  std::string id;    // Component the edit applies to, the input side of a connection
+  std::string from;  // Driving component of EDIT_CONNECT
+  int type;          // ComponentCode of EDIT_INSERT, new state of EDIT_STATE
+  float x, y;        // Position of EDIT_INSERT and EDIT_MOVE
+  int pin;           // Input pin of EDIT_CONNECT and EDIT_DISCONNECT
+  int fromPin;       // Output pin of EDIT_CONNECT
+}EditOp;
+
+void WriteEditText(BufferedWriter& out, const EditOp& op);
+// Reads every complete record, a torn or malformed record ends the log (everything after a crash is lost anyway)
+void ReadEdits(std::string_view text, std::vector<EditOp>& ops);
+// Replays edits on loaded board records the way Board replays them on components, edits that do not fit are skipped
+void ApplyEdits(BoardData& data, const std::vector<EditOp>& ops);
@@ -0,0 +1,87 @@
+#include "MappedFile.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+  this->data = nullptr;
+  this->size = 0;
+  this->handle = nullptr;
+}
+MappedFile::~MappedFile() {
+  this->Close();
+}
+bool MappedFile::Open(const std::string& fileName) {
+  this->Close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  this->size = (size_t)size.QuadPart;
+  // An empty file cannot be mapped, it is still a valid (empty) open
+  if (this->size == 0) {
+    CloseHandle(file);
+    return true;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL) {
+    this->size = 0;
+    return false;
+  }
+  const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == NULL) {
+    CloseHandle(mapping);
+    this->size = 0;
+    return false;
+  }
+  this->handle = mapping;
+  this->data = (const char*)view;
+#else
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return false;
+  }
+  this->size = (size_t)info.st_size;
+  if (this->size == 0) {
+    close(fd);
+    return true;
+  }
+  void* view = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps its own reference to the file
+  if (view == MAP_FAILED) {
+    this->size = 0;
+    return false;
+  }
+  // Loading walks the file front to back exactly once
+  madvise(view, this->size, MADV_SEQUENTIAL);
+  this->data = (const char*)view;
+#endif
+  return true;
+}
+void MappedFile::Close() {
+  if (this->data) {
+#ifdef _WIN32
+    UnmapViewOfFile(this->data);
+    CloseHandle((HANDLE)this->handle);
+#else
+    munmap((void*)this->data, this->size);
+#endif
+  }
+  this->data = nullptr;
+  this->size = 0;
+  this->handle = nullptr;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read only view of a whole file mapped into memory, the bytes stay valid until Close or destruction
+class MappedFile {
+public:
+  const char* data;
+  size_t size;
+  void* handle;  // File mapping object on Windows
+  MappedFile();
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  bool Open(const std::string& fileName);
+  void Close();
+};
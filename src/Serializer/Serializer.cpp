@@ -0,0 +1,252 @@
+#include "Serializer.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "BinaryFormat.hpp"
+#include "Compression.hpp"
+#include "MappedFile.hpp"
+#include "EditLog.hpp"
+
+int GateCode(GateType type) {
+  switch (type) {
+  case AND: return CODE_AND;
+  case OR: return CODE_OR;
+  case NOT: return CODE_NOT;
+  case NAND: return CODE_NAND;
+  case NOR: return CODE_NOR;
+  case XOR: return CODE_XOR;
+  }
+  return CODE_AND;
+}
+void PinCounts(int code, int& inputCount, int& outputCount) {
+  GateType type;
+  inputCount = code == CODE_BULB ? 1 : 0;
+  outputCount = code == CODE_BULB ? 0 : 1;
+  if (CodeToGate(code, type))inputCount = type == NOT ? 1 : 2;
+}
+bool CodeToGate(int code, GateType& type) {
+  switch (code) {
+  case CODE_AND: type = AND; return true;
+  case CODE_OR: type = OR; return true;
+  case CODE_NOT: type = NOT; return true;
+  case CODE_NAND: type = NAND; return true;
+  case CODE_NOR: type = NOR; return true;
+  case CODE_XOR: type = XOR; return true;
+  }
+  return false;
+}
+
+void WriteComponentText(BufferedWriter& out, const ComponentView& comp) {
+  out.Write(comp.id);
+  out.Put(',');
+  out.WriteInt(comp.type);
+  out.Put(',');
+  out.WriteFloat(comp.x);
+  out.Put(',');
+  out.WriteFloat(comp.y);
+  out.Put(',');
+  out.WriteInt(comp.inputCount);
+  out.Put(',');
+  out.WriteInt(comp.outputCount);
+  out.Put(',');
+  out.Put(comp.state ? '1' : '0');
+  out.Put(';');
+}
+void WriteConnectionText(BufferedWriter& out, const ConnectionView& conn) {
+  out.Write(conn.to);
+  out.Put(',');
+  if (conn.from.empty())out.Put('-');
+  else out.Write(conn.from);
+  out.Put(',');
+  out.WriteInt(conn.toPin);
+  out.Put(',');
+  if (conn.from.empty())out.Put('-');
+  else out.WriteInt(conn.fromPin);
+  out.Put(';');
+}
+void WriteBoardText(BufferedWriter& out, const BoardData& data) {
+  if (data.components.empty())return;
+  // Components
+  for (const ComponentRecord& comp : data.components) {
+    WriteComponentText(out, { comp.id, comp.type, comp.x, comp.y, comp.inputCount, comp.outputCount, comp.state });
+  }
+  out.Put('|');
+  // Connections
+  for (const ConnectionRecord& conn : data.connections) {
+    WriteConnectionText(out, { conn.to, conn.from, conn.toPin, conn.fromPin });
+  }
+  out.Put('|');
+  // Heads
+  for (size_t i = 0;i < data.heads.size();i++) {
+    if (i > 0)out.Put(',');
+    out.Write(data.heads[i]);
+  }
+}
+static std::string_view Trim(std::string_view field) {
+  size_t start = 0, end = field.size();
+  while (start < end && (field[start] == ' ' || field[start] == '\t' || field[start] == '\r' || field[start] == '\n'))start++;
+  while (end > start && (field[end - 1] == ' ' || field[end - 1] == '\t' || field[end - 1] == '\r' || field[end - 1] == '\n'))end--;
+  return field.substr(start, end - start);
+}
+
+TextBoardParser::TextBoardParser(std::string_view text) {
+  this->text = text;
+  this->position = 0;
+  this->failed = false;
+  this->headPending = false;
+  this->headsEnd = std::string_view::npos;
+}
+// Splits the next `;` terminated record of the current section into at most maxFields trimmed fields and returns
+// how many it had, 0 at the end of the section. A record cut short by the end of the section is dropped.
+int TextBoardParser::NextRecord(std::string_view* fields, int maxFields) {
+  size_t pos = this->position;
+  int count = 0;
+  while (true) {
+    size_t end = this->text.find_first_of(",;|", pos);
+    if (end == std::string_view::npos || this->text[end] == '|') {
+      this->position = end == std::string_view::npos ? this->text.size() : end;
+      return 0;
+    }
+    if (count < maxFields)fields[count] = Trim(this->text.substr(pos, end - pos));
+    count++;
+    pos = end + 1;
+    if (this->text[end] == ';') {
+      this->position = pos;
+      return count;
+    }
+  }
+}
+bool TextBoardParser::NextComponent(ComponentView& comp) {
+  std::string_view fields[7];
+  int count = this->NextRecord(fields, 7);
+  if (count == 0)return false;
+  if (count < 7 || !ParseNumber(fields[1], comp.type) || !ParseNumber(fields[2], comp.x) || !ParseNumber(fields[3], comp.y)
+    || !ParseNumber(fields[4], comp.inputCount) || !ParseNumber(fields[5], comp.outputCount)
+    || comp.type < CODE_SWITCH || comp.type > CODE_XOR) {
+    this->failed = true;
+    return false;
+  }
+  comp.id = fields[0];
+  comp.state = fields[6] == "1";
+  return true;
+}
+bool TextBoardParser::NextConnection(ConnectionView& conn) {
+  std::string_view fields[4];
+  int count = this->NextRecord(fields, 4);
+  if (count == 0)return false;
+  if (count < 4 || !ParseNumber(fields[2], conn.toPin)) {
+    this->failed = true;
+    return false;
+  }
+  conn.to = fields[0];
+  bool connected = fields[1] != "-" && fields[3] != "-";
+  conn.from = connected ? fields[1] : std::string_view();
+  conn.fromPin = 0;
+  if (connected && !ParseNumber(fields[3], conn.fromPin)) {
+    this->failed = true;
+    return false;
+  }
+  return true;
+}
+bool TextBoardParser::EndSection() {
+  if (this->failed || this->position >= this->text.size() || this->text[this->position] != '|') {
+    this->failed = true;
+    return false;
+  }
+  this->position++;
+  // An empty heads section holds no heads at all, otherwise every comma separated field is one
+  size_t end = this->text.find('|', this->position);
+  this->headsEnd = end;
+  this->headPending = !Trim(this->text.substr(this->position, end == std::string_view::npos ? std::string_view::npos : end - this->position)).empty();
+  return true;
+}
+bool TextBoardParser::NextHead(std::string_view& head) {
+  if (!this->headPending)return false;
+  size_t end = std::min(this->text.find(',', this->position), this->headsEnd);
+  if (end == std::string_view::npos)end = this->text.size();
+  head = Trim(this->text.substr(this->position, end - this->position));
+  this->headPending = end < this->text.size() && this->text[end] == ',';
+  this->position = end < this->text.size() ? end + 1 : end;
+  return true;
+}
+
+std::string_view TextBoardParser::EditSection() const {
+  if (this->headsEnd == std::string_view::npos)return std::string_view();
+  return this->text.substr(this->headsEnd + 1);
+}
+
+bool DeserializeBoard(std::string_view text, BoardData& data) {
+  data.components.clear();
+  data.connections.clear();
+  data.heads.clear();
+  TextBoardParser parser(text);
+  // Load Components First
+  ComponentView comp;
+  while (parser.NextComponent(comp)) {
+    data.components.push_back({ std::string(comp.id), comp.type, comp.x, comp.y, comp.inputCount, comp.outputCount, comp.state });
+  }
+  if (!parser.EndSection())return false;
+  // Load the Connections
+  ConnectionView conn;
+  while (parser.NextConnection(conn)) {
+    data.connections.push_back({ std::string(conn.to), std::string(conn.from), conn.toPin, conn.fromPin });
+  }
+  if (!parser.EndSection())return false;
+  // Load the Heads
+  std::string_view head;
+  while (parser.NextHead(head))data.heads.push_back(std::string(head));
+  // Edits appended by delta saves
+  std::vector<EditOp> edits;
+  ReadEdits(parser.EditSection(), edits);
+  ApplyEdits(data, edits);
+  return true;
+}
+bool LoadBoardFile(const std::string& fileName, BoardData& data) {
+  // Compressed boards are unpacked first, then binary boards are recognised by their magic, everything else is text
+  MappedFile mapped;
+  if (!mapped.Open(fileName))return false;
+  std::string buffer;
+  std::string_view bytes;
+  if (!UnpackBoard(mapped.data, mapped.size, buffer, bytes))return false;
+  if (IsBinaryBoard(bytes.data(), bytes.size())) {
+    BoardView view;
+    if (!view.Parse(bytes.data(), bytes.size()))return false;
+    ReadBinaryBoard(view, data);
+    return true;
+  }
+  return DeserializeBoard(bytes, data);
+}
+bool SaveBoardFile(const std::string& fileName, const BoardData& data, bool compress) {
+  BufferedWriter out;
+  if (!out.Open(fileName))return false;
+  if (compress)out.Compress();
+  if (UsesBinaryFormat(fileName))WriteBinaryBoard(out, data);
+  else WriteBoardText(out, data);
+  return out.Close();
+}
+
+void BuildNetNodes(const BoardData& data, NetDescription& description) {
+  std::map<std::string, int> index;
+  description.Clear();
+  for (size_t i = 0;i < data.components.size();i++) {
+    const ComponentRecord& comp = data.components[i];
+    index[comp.id] = (int)i;
+    if (comp.type == CODE_SWITCH || comp.type == CODE_CLOCK)description.AddNode(NODE_SOURCE, AND, 1, comp.state, 0);
+    else if (comp.type == CODE_BULB)description.AddNode(NODE_SINK, AND, 0, comp.state, 1);
+    else {
+      GateType type = AND;
+      CodeToGate(comp.type, type);
+      description.AddNode(NODE_GATE, type, 1, comp.state, type == NOT ? 1 : 2);
+    }
+  }
+  for (const ConnectionRecord& conn : data.connections) {
+    if (conn.from.empty())continue;
+    auto to = index.find(conn.to);
+    auto from = index.find(conn.from);
+    if (to == index.end() || from == index.end())continue;
+    PinRef* inputs = description.Inputs(to->second);
+    if (conn.toPin < 0 || conn.toPin >= description.nodes[to->second].inputCount || inputs[conn.toPin].node >= 0)continue;
+    inputs[conn.toPin] = { from->second, conn.fromPin };
+  }
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Netlist/Netlist.hpp"
+#include "BufferedWriter.hpp"
+
+/**
+ * Type codes of the save format
+ * 1. Switch
+ * 2. Bulb
+ * 3. Clock
+ * 4. AND Gate
+ * 5. OR Gate
+ * 6. NOT Gate
+ * 7. NAND Gate
+ * 8. NOR Gate
+ * 9. XOR Gate
+ */
+typedef enum ComponentCode {
+  CODE_SWITCH = 1, CODE_BULB, CODE_CLOCK, CODE_AND, CODE_OR, CODE_NOT, CODE_NAND, CODE_NOR, CODE_XOR
+}ComponentCode;
+
+typedef struct ComponentRecord {
+  std::string id;
+  int type;
+  float x, y;
+  int inputCount;
+  int outputCount;
+  bool state;
+}ComponentRecord;
+
+// One record per input pin, an empty from means the pin is not connected
+typedef struct ConnectionRecord {
+  std::string to;
+  std::string from;
+  int toPin;
+  int fromPin;
+}ConnectionRecord;
+
+// Everything a board file holds, free of any rendering state
+typedef struct BoardData {
+  std::vector<ComponentRecord> components;
+  std::vector<ConnectionRecord> connections;
+  std::vector<std::string> heads;
+}BoardData;
+
+// Fields of a text record, the ids are views into the parsed text
+typedef struct ComponentView {
+  std::string_view id;
+  int type;
+  float x, y;
+  int inputCount;
+  int outputCount;
+  bool state;
+}ComponentView;
+
+// An empty from means the pin is not connected
+typedef struct ConnectionView {
+  std::string_view to;
+  std::string_view from;
+  int toPin;
+  int fromPin;
+}ConnectionView;
+
+// Whole field as a number, no leading or trailing characters allowed
+template <typename T>
+inline bool ParseNumber(std::string_view field, T& value) {
+  std::from_chars_result result = std::from_chars(field.data(), field.data() + field.size(), value);
+  return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+// Single pass reader of the text format `id,type,x,y,in,out,state;...|to,from,toPin,fromPin;...|head,...[|edits]`.
+// The sections are read in order: NextComponent until it returns false, EndSection, NextConnection until false,
+// EndSection, then NextHead. Nothing is copied, whitespace around fields is ignored and a malformed record sets failed.
+// Saves that only appended their changes leave EditLog records in an optional fourth section.
+class TextBoardParser {
+public:
+  std::string_view text;
+  size_t position;
+  bool failed;
+  bool headPending; // The heads section still has a (possibly empty) head to hand out
+  size_t headsEnd;  // The '|' closing the heads section, npos without an edit section
+  TextBoardParser(std::string_view text);
+  bool NextComponent(ComponentView& comp);
+  bool NextConnection(ConnectionView& conn);
+  bool EndSection();
+  bool NextHead(std::string_view& head);
+  std::string_view EditSection() const;
+  int NextRecord(std::string_view* fields, int maxFields);
+};
+
+int GateCode(GateType type);
+bool CodeToGate(int code, GateType& type);
+void PinCounts(int code, int& inputCount, int& outputCount); // Pins of a freshly inserted component
+
+// Record writers of the text format, a board is its components, '|', its connections, '|' and its comma separated heads
+void WriteComponentText(BufferedWriter& out, const ComponentView& comp);
+void WriteConnectionText(BufferedWriter& out, const ConnectionView& conn);
+void WriteBoardText(BufferedWriter& out, const BoardData& data);
+// Text board, edits appended by delta saves included
+bool DeserializeBoard(std::string_view text, BoardData& data);
+// Loading detects compressed and binary boards by their header, saving writes the binary format for *.gwb files and text otherwise
+bool LoadBoardFile(const std::string& fileName, BoardData& data);
+bool SaveBoardFile(const std::string& fileName, const BoardData& data, bool compress = false);
+
+// Netlist nodes of a loaded board, node i is data.components[i]
+void BuildNetNodes(const BoardData& data, NetDescription& description);
@@ -148,23 +148,23 @@ void HomeScreen::Draw() {
   GuiGroupBox((Rectangle) { 8, 72, 984, 520 }, "CIRCUIT BOARD");
   GuiGroupBox((Rectangle) { 8, 16, 520, 40 }, "COMPONENTS");
   if (GuiButton((Rectangle) { 16, 24, 56, 24 }, "AND")) {
-    this->board->InsertGate("", AND, this->board->textures["and"]);
+    this->board->InsertGate("", AND, this->board->atlas.Get("and"));
     //std::cout << "And Gate" << std::endl;
   }
   if (GuiButton((Rectangle) { 408, 24, 56, 24 }, "BULB")) {
-    this->board->InsertBulb("", this->board->textures["bulb_on"], this->board->textures["bulb_off"]);
+    this->board->InsertBulb("", this->board->atlas.Get("bulb_on"), this->board->atlas.Get("bulb_off"));
     std::cout << "Bulb" << std::endl;
   }
   if (GuiButton((Rectangle) { 72, 24, 56, 24 }, "OR")) {
-    this->board->InsertGate("", OR, this->board->textures["or"]);
+    this->board->InsertGate("", OR, this->board->atlas.Get("or"));
     std::cout << "Or Gate" << std::endl;
   }
   if (GuiButton((Rectangle) { 184, 24, 56, 24 }, "NAND")) {
-    this->board->InsertGate("", NAND, this->board->textures["nand"]);
+    this->board->InsertGate("", NAND, this->board->atlas.Get("nand"));
     std::cout << "Nand Gate" << std::endl;
   }
   if (GuiButton((Rectangle) { 352, 24, 56, 24 }, "SWITCH")) {
-    this->board->InsertSwitch("", this->board->textures["switch_on"], this->board->textures["switch_off"]);
+    this->board->InsertSwitch("", this->board->atlas.Get("switch_on"), this->board->atlas.Get("switch_off"));
     std::cout << "Switch" << std::endl;
   }
   if (GuiButton((Rectangle) { 464, 24, 56, 24 }, "CLOCK")) {
@@ -172,15 +172,15 @@ void HomeScreen::Draw() {
     std::cout << "Clock Inserted\n";
   }
   if (GuiButton((Rectangle) { 128, 24, 56, 24 }, "NOT")) {
-    this->board->InsertGate("", NOT, this->board->textures["not"]);
+    this->board->InsertGate("", NOT, this->board->atlas.Get("not"));
     std::cout << "Not Gate" << std::endl;
   }
   if (GuiButton((Rectangle) { 296, 24, 56, 24 }, "XOR")) {
-    this->board->InsertGate("", XOR, this->board->textures["xor"]);
+    this->board->InsertGate("", XOR, this->board->atlas.Get("xor"));
     std::cout << "XOR Gate" << std::endl;
   }
   if (GuiButton((Rectangle) { 240, 24, 56, 24 }, "NOR")) {
-    this->board->InsertGate("", NOR, this->board->textures["nor"]);
+    this->board->InsertGate("", NOR, this->board->atlas.Get("nor"));
     std::cout << "NOR Gate" << std::endl;
   }
   GuiGroupBox((Rectangle) { 536, 16, 216, 40 }, "MENU");
@@ -202,6 +202,16 @@ void HomeScreen::Draw() {
   if (GuiButton((Rectangle) { 616, 24, 72, 24 }, (this->board->simulationRunning ? "#132#STOP" : "#131#START"))) {
     this->board->simulationRunning = !this->board->simulationRunning;
   }
+  GuiGroupBox((Rectangle) { 760, 16, 232, 40 }, "SIMULATION");
+  if (GuiButton((Rectangle) { 768, 24, 112, 24 }, (this->board->simulationMode == SIM_EVENT_DRIVEN ? "MODE: EVENT" : "MODE: SWEEP"))) {
+    this->board->SetSimulationMode(this->board->simulationMode == SIM_EVENT_DRIVEN ? SIM_LEVELIZED : SIM_EVENT_DRIVEN);
+  }
+  // Ticks of virtual time per second on the simulation thread, cycles like the Clock frequencies
+  double tickRate = this->board->simThread.GetTickRate();
+  std::string rateLabel = tickRate >= 1e6 ? "RATE: 1 MHz" : tickRate >= 1e5 ? "RATE: 100 kHz" : tickRate >= 1e4 ? "RATE: 10 kHz" : "RATE: 1 kHz";
+  if (GuiButton((Rectangle) { 888, 24, 96, 24 }, rateLabel.c_str())) {
+    this->board->simThread.SetTickRate(tickRate >= 1e6 ? 1e3 : tickRate * 10);
+  }
 
 
   this->board->Draw();
@@ -239,6 +249,7 @@ void HomeScreen::Draw() {
     this->messageBoxResponse = -1;
   }
   else if (messageBoxResponse == 2) {
+    this->board->DiscardJournal();
     this->board->ClearBoard();
     this->toBeLoaded = false;
     this->toShowMessageBox = false;
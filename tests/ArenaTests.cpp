@@ -0,0 +1,56 @@
+// Board arena: freed blocks come back from the free lists, Reset reuses the chunks it already has
+#include <vector>
+#include "Check.hpp"
+#include "Board/Arena.hpp"
+
+static void TestFreeListReuse() {
+  Arena arena(1024);
+  void* a = arena.Allocate(24);
+  void* b = arena.Allocate(24);
+  void* c = arena.Allocate(100);
+  CHECK(arena.live == 3);
+  arena.Free(a);
+  arena.Free(b);
+  CHECK(arena.live == 1);
+  // Same size class comes back last freed first, without carving anything new
+  char* cursor = arena.cursor;
+  CHECK(arena.Allocate(20) == b);
+  CHECK(arena.Allocate(32) == a);
+  CHECK(arena.cursor == cursor);
+  // Another size class does not take the freed block
+  arena.Free(c);
+  void* d = arena.Allocate(24);
+  CHECK(d != c);
+  CHECK(arena.Allocate(112) == c);
+  // Blocks above the pooled classes go to the heap and never into a chunk
+  size_t chunks = arena.chunks.size();
+  void* large = arena.Allocate(4096);
+  CHECK(arena.chunks.size() == chunks);
+  arena.Free(large);
+  CHECK(arena.live == 4);
+}
+
+static void TestResetReusesChunks() {
+  Arena arena(1024);
+  std::vector<void*> blocks;
+  for (int i = 0;i < 100;i++)blocks.push_back(arena.Allocate(48));
+  CHECK(arena.chunks.size() > 2);
+  std::vector<char*> chunks = arena.chunks;
+  arena.Reset();
+  CHECK(arena.live == 0);
+  // The same allocations land on the same addresses in the same chunks
+  bool same = true;
+  for (int i = 0;i < 100;i++)same = same && arena.Allocate(48) == blocks[i];
+  CHECK(same);
+  CHECK(arena.chunks == chunks);
+  // Blocks freed before a Reset are forgotten, the cursor starts over at the first chunk
+  arena.Free(blocks[5]);
+  arena.Reset();
+  CHECK(arena.Allocate(48) == blocks[0]);
+}
+
+int main() {
+  TestFreeListReuse();
+  TestResetReusesChunks();
+  return CheckResult();
+}
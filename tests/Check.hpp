@@ -0,0 +1,17 @@
+#pragma once
+#include <iostream>
+
+// Minimal checks for the core tests, failures are reported and counted, main returns CheckResult()
+static int checkFailures = 0;
+
+#define CHECK(condition) do { \
+  if (!(condition)) { \
+    std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+    checkFailures++; \
+  } \
+} while (0)
+
+static int CheckResult() {
+  if (checkFailures > 0)std::cerr << checkFailures << " checks failed" << std::endl;
+  return checkFailures > 0 ? 1 : 0;
+}
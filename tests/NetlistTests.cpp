@@ -0,0 +1,180 @@
+// Netlist evaluation: the levelized sweep, event driven propagation and the batch kernels have to agree
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Check.hpp"
+#include "Netlist/Netlist.hpp"
+#include "Netlist/BatchEvaluator.hpp"
+#include "Netlist/Kernels.hpp"
+
+// Random board of sources, gates and sinks, gates only read lower nodes unless feedback is allowed
+static NetDescription RandomBoard(std::mt19937& rng, int sourceCount, int gateCount, int sinkCount, bool feedback) {
+  NetDescription board;
+  for (int i = 0;i < sourceCount;i++)board.AddNode(NODE_SOURCE, AND, 1, (rng() & 1) != 0, 0);
+  for (int i = 0;i < gateCount;i++) {
+    GateType type = (GateType)(rng() % 6);
+    int node = board.AddNode(NODE_GATE, type, 1, false, type == NOT ? 1 : 2);
+    int reach = feedback ? sourceCount + gateCount : node;
+    for (int j = 0;j < board.nodes[node].inputCount;j++) {
+      // An open input now and then
+      if (rng() % 16 != 0)board.Inputs(node)[j] = { (int)(rng() % reach), 0 };
+    }
+  }
+  for (int i = 0;i < sinkCount;i++) {
+    int node = board.AddNode(NODE_SINK, AND, 0, false, 1);
+    board.Inputs(node)[0] = { sourceCount + (int)(rng() % gateCount), 0 };
+  }
+  return board;
+}
+
+static void TestEventDrivenMatchesLevelized() {
+  std::mt19937 rng(1);
+  for (int board = 0;board < 50;board++) {
+    NetDescription description = RandomBoard(rng, 6, 40, 8, true);
+    Netlist sweep;
+    sweep.Compile(description);
+    Netlist event = sweep;
+    event.ScheduleAll();
+    for (int tick = 0;tick < 100;tick++) {
+      for (int node : sweep.sources) {
+        bool value = tick == 0 ? sweep.GetState(node) : rng() % 4 == 0 ? !sweep.GetState(node) : sweep.GetState(node);
+        sweep.SetSource(node, value);
+        event.DriveSource(node, value);
+      }
+      sweep.Evaluate();
+      event.Propagate();
+      event.changed.clear();
+      bool same = true;
+      for (int node = 0;node < description.Size();node++)same = same && sweep.GetState(node) == event.GetState(node);
+      CHECK(same);
+      if (!same)return;
+    }
+  }
+}
+
+static void TestBatchMatchesScalar() {
+  std::mt19937 rng(2);
+  KernelLevel levels[] = { KERNEL_SCALAR, KERNEL_AVX2, KERNEL_AVX512 };
+  for (KernelLevel level : levels) {
+    const GateKernels& kernels = GetKernels(level);
+    for (int board = 0;board < 20;board++) {
+      NetDescription description = RandomBoard(rng, 8, 60, 8, false);
+      Netlist netlist;
+      netlist.Compile(description);
+      int words = kernels.words * 2;
+      BatchEvaluator batch(&netlist, words, &kernels);
+      for (int node : netlist.sources) {
+        uint64_t* source = batch.GetSource(node);
+        for (int w = 0;w < words;w++)source[w] = ((uint64_t)rng() << 32) | rng();
+      }
+      batch.Evaluate();
+      bool same = true;
+      for (int lane = 0;lane < 64 * words && same;lane++) {
+        for (int node : netlist.sources)netlist.SetSource(node, (batch.GetSource(node)[lane / 64] >> (lane % 64)) & 1);
+        netlist.Evaluate();
+        for (int node = 0;node < description.Size();node++) {
+          same = same && netlist.GetState(node) == (bool)((batch.GetState(node)[lane / 64] >> (lane % 64)) & 1);
+        }
+      }
+      CHECK(same);
+    }
+  }
+}
+
+static void TestTruthTableMatchesScalar() {
+  std::mt19937 rng(3);
+  for (int board = 0;board < 20;board++) {
+    Netlist netlist;
+    netlist.Compile(RandomBoard(rng, 1 + board % 10, 30, 4, false));
+    TruthTable table;
+    CHECK(SweepTruthTable(netlist, table));
+    bool same = true;
+    for (uint64_t row = 0;row < table.rows && same;row++) {
+      for (size_t i = 0;i < table.inputs.size();i++)netlist.SetSource(table.inputs[i], (row >> i) & 1);
+      netlist.Evaluate();
+      for (size_t o = 0;o < table.outputs.size();o++)same = same && table.Get((int)o, row) == netlist.GetState(table.outputs[o]);
+    }
+    CHECK(same);
+  }
+  // Feedback loops have no truth table
+  NetDescription latch;
+  latch.AddNode(NODE_SOURCE, AND, 1, false, 0);
+  latch.AddNode(NODE_GATE, NOR, 1, false, 2);
+  latch.AddNode(NODE_GATE, NOR, 1, false, 2);
+  latch.Inputs(1)[0] = { 0, 0 };
+  latch.Inputs(1)[1] = { 2, 0 };
+  latch.Inputs(2)[0] = { 1, 0 };
+  latch.Inputs(2)[1] = { 0, 0 };
+  Netlist netlist;
+  netlist.Compile(latch);
+  TruthTable table;
+  CHECK(netlist.cyclic);
+  CHECK(!SweepTruthTable(netlist, table));
+  // Cutting either wire of the loop gives the truth table back, the patch has to leave that to a new compile
+  for (int node = 1;node <= 2;node++) {
+    NetDescription open = latch;
+    Netlist cut;
+    cut.Compile(open);
+    open.Inputs(node)[node == 1 ? 1 : 0] = { -1, 0 };
+    if (!cut.Reconnect(open, node, node == 1 ? 1 : 0))cut.Compile(open);
+    CHECK(!cut.cyclic);
+    CHECK(SweepTruthTable(cut, table));
+  }
+}
+
+// Connects and disconnects patched into a compiled netlist have to evaluate like a netlist compiled from scratch
+static void TestReconnectMatchesCompile() {
+  std::mt19937 rng(7);
+  int patched = 0;
+  for (int board = 0;board < 20;board++) {
+    NetDescription description = RandomBoard(rng, 6, 40, 8, board % 2 == 1);
+    Netlist sweep;
+    sweep.Compile(description);
+    Netlist event = sweep;
+    event.ScheduleAll();
+    for (int edit = 0;edit < 200;edit++) {
+      int node = 6 + (int)(rng() % (description.Size() - 6));
+      int pin = (int)(rng() % description.nodes[node].inputCount);
+      if (rng() % 4 == 0)description.Inputs(node)[pin] = { -1, 0 };
+      else description.Inputs(node)[pin] = { (int)(rng() % (6 + 40)), 0 };
+      if (sweep.Reconnect(description, node, pin) && event.Reconnect(description, node, pin))patched++;
+      else {
+        sweep.Compile(description);
+        event.Compile(description);
+        event.ScheduleAll();
+      }
+      Netlist fresh;
+      fresh.Compile(description);
+      for (int node : fresh.sources) {
+        bool value = (rng() & 1) != 0;
+        fresh.SetSource(node, value);
+        sweep.SetSource(node, value);
+        event.DriveSource(node, value);
+      }
+      // Feedback loops may take a few ticks to settle, the same inputs are applied until they did
+      bool same = true;
+      for (int tick = 0;tick < 2 * description.Size();tick++) {
+        fresh.Evaluate();
+        sweep.Evaluate();
+        event.Propagate();
+        event.changed.clear();
+      }
+      for (int node = 0;node < description.Size();node++) {
+        same = same && sweep.GetState(node) == fresh.GetState(node) && event.GetState(node) == fresh.GetState(node);
+      }
+      CHECK(same || fresh.cyclic);
+      CHECK(sweep.cyclic == fresh.cyclic);
+      if (!same && !fresh.cyclic)return;
+    }
+  }
+  // Most of the edits keep the level order, boards with feedback loops compile again whenever a wire goes away
+  CHECK(patched > 500);
+}
+
+int main() {
+  TestEventDrivenMatchesLevelized();
+  TestBatchMatchesScalar();
+  TestTruthTableMatchesScalar();
+  TestReconnectMatchesCompile();
+  return CheckResult();
+}
@@ -0,0 +1,74 @@
+// gateworks-run: jumping from event to event with --until has to end where ticking through every tick ends, and
+// malformed arguments or stimulus files are refused
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "Check.hpp"
+
+static std::string runner;
+
+static void WriteText(const std::string& fileName, const std::string& text) {
+  std::ofstream file(fileName, std::ios::binary);
+  file << text;
+}
+
+// Runs the runner on the board and returns the bulb states it printed
+static std::string Run(const std::string& arguments) {
+  std::string command = "\"" + runner + "\" " + arguments + " > test_runner.out";
+  if (std::system(command.c_str()) != 0)return "failed";
+  std::ifstream file("test_runner.out");
+  std::stringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+static void TestUntilMatchesTicks() {
+  // NOR latch, the switch S sets it, R resets it, QA and QB show both sides
+  WriteText("test_latch.txt",
+    "S,1,0,0,0,1,0;R,1,0,100,0,1,0;A,8,100,0,2,1,0;B,8,100,100,2,1,0;QA,2,200,0,1,0,0;QB,2,200,100,1,0,0;|"
+    "A,R,0,0;A,B,1,0;B,S,0,0;B,A,1,0;QA,A,0,0;QB,B,0,0;|S");
+  // The loop takes more than one tick to settle after the last stimulus, there is no event left to jump to
+  WriteText("test_latch.stim", "0 R=1\n5 R=0\n10 S=1\n");
+  for (const char* mode : { "sweep", "event" }) {
+    std::string board = "test_latch.txt --stimulus test_latch.stim --mode " + std::string(mode);
+    std::string ticked = Run(board + " --ticks 14");
+    CHECK(ticked == "QA=1\nQB=0\n");
+    CHECK(Run(board + " --until 0.014 --rate 1000") == ticked);
+  }
+  std::remove("test_latch.txt");
+  std::remove("test_latch.stim");
+  std::remove("test_runner.out");
+}
+
+static void TestRejectsBadInput() {
+  WriteText("test_bad.txt", "S,1,0,0,0,1,0;C,3,0,100,0,1,0;Q,2,200,0,1,0,0;|Q,S,0,0;|Q");
+  CHECK(Run("test_bad.txt --ticks 3") == "Q=0\n");
+  // Typos used to fall back to a default and run anyway
+  CHECK(Run("test_bad.txt --mode events") == "failed");
+  CHECK(Run("test_bad.txt --ticks 3x") == "failed");
+  CHECK(Run("test_bad.txt --rate fast") == "failed");
+  CHECK(Run("test_bad.txt --until 1s") == "failed");
+  CHECK(Run("test_bad.txt --clock C=2Hz") == "failed");
+  for (const char* stimulus : { "0 S=2\n", "0 S=\n", "0 S\n", "x S=1\n", "1.5 S=1\n" }) {
+    WriteText("test_bad.stim", stimulus);
+    CHECK(Run("test_bad.txt --stimulus test_bad.stim") == "failed");
+  }
+  WriteText("test_bad.stim", "# comment\n\n0 S=1\n");
+  CHECK(Run("test_bad.txt --stimulus test_bad.stim") == "Q=1\n");
+  std::remove("test_bad.txt");
+  std::remove("test_bad.stim");
+  std::remove("test_runner.out");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: RunnerTests <gateworks-run>" << std::endl;
+    return 2;
+  }
+  runner = argv[1];
+  TestUntilMatchesTicks();
+  TestRejectsBadInput();
+  return CheckResult();
+}
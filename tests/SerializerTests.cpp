@@ -0,0 +1,271 @@
+// Board files: text, binary and compressed round trips, delta saves and journal replay
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "Serializer/Serializer.hpp"
+#include "Serializer/BinaryFormat.hpp"
+#include "Serializer/BoardSaver.hpp"
+#include "Serializer/BufferedWriter.hpp"
+#include "Serializer/Compression.hpp"
+#include "Serializer/EditLog.hpp"
+#include "Serializer/MappedFile.hpp"
+
+// Board with the long timestamp ids the GUI hands out, every input pin has a record like Board::SaveBoard writes
+static BoardData RandomBoard(std::mt19937& rng, int count) {
+  BoardData data;
+  char id[64];
+  for (int i = 0;i < count;i++) {
+    snprintf(id, sizeof(id), "Gate_20250718_%06d_%03d", 101010 + i / 1000, i % 1000);
+    ComponentRecord comp = { id, CODE_SWITCH + (int)(rng() % 9), (float)(rng() % 2000) - 500.0f, (float)(rng() % 1000) / 4.0f, 0, 0, (rng() & 1) != 0 };
+    PinCounts(comp.type, comp.inputCount, comp.outputCount);
+    data.components.push_back(comp);
+  }
+  for (const ComponentRecord& comp : data.components) {
+    for (int pin = 0;pin < comp.inputCount;pin++) {
+      const ComponentRecord& from = data.components[rng() % count];
+      if (from.outputCount > 0 && rng() % 4 != 0)data.connections.push_back({ comp.id, from.id, pin, 0 });
+      else data.connections.push_back({ comp.id, "", pin, 0 });
+    }
+  }
+  for (int i = 0;i < count;i += 7)data.heads.push_back(data.components[i].id);
+  return data;
+}
+
+// Everything a board file stands for, independent of the order and the open pins of the connection records
+static std::string Describe(const BoardData& data) {
+  std::map<std::string, std::string> pins;
+  for (const ConnectionRecord& conn : data.connections) {
+    if (!conn.from.empty())pins[conn.to + "," + std::to_string(conn.toPin)] = conn.from + "," + std::to_string(conn.fromPin);
+  }
+  std::string text;
+  for (const ComponentRecord& comp : data.components) {
+    text += comp.id + "," + std::to_string(comp.type) + "," + std::to_string(comp.x) + "," + std::to_string(comp.y) + ",";
+    text += std::to_string(comp.inputCount) + "," + std::to_string(comp.outputCount) + "," + std::to_string(comp.state) + ";";
+  }
+  for (auto& pin : pins)text += pin.first + "=" + pin.second + ";";
+  for (const std::string& head : data.heads)text += head + ",";
+  return text;
+}
+
+// Binary image of a board in memory
+static std::string BinaryImage(const BoardData& data) {
+  std::string image;
+  BufferedWriter out(&image);
+  WriteBinaryBoard(out, data);
+  out.Flush();
+  return image;
+}
+
+static void TestRoundTrips() {
+  std::mt19937 rng(4);
+  for (int count : { 1, 10, 3000 }) {
+    BoardData data = RandomBoard(rng, count);
+    for (int binary = 0;binary < 2;binary++) {
+      for (int compress = 0;compress < 2;compress++) {
+        std::string fileName = binary ? "test_round_trip.gwb" : "test_round_trip.txt";
+        CHECK(SaveBoardFile(fileName, data, compress));
+        BoardData loaded;
+        CHECK(LoadBoardFile(fileName, loaded));
+        CHECK(Describe(loaded) == Describe(data));
+        std::remove(fileName.c_str());
+      }
+    }
+  }
+  // Repeated ids are what compression is for
+  BoardData data = RandomBoard(rng, 3000);
+  std::string plain, packed;
+  {
+    BufferedWriter out(&plain);
+    WriteBoardText(out, data);
+    BufferedWriter compressed(&packed);
+    compressed.Compress();
+    WriteBoardText(compressed, data);
+  }
+  CHECK(packed.size() * 3 < plain.size());
+}
+
+static void TestTextParser() {
+  // Whitespace around the fields is ignored
+  BoardData data;
+  CHECK(DeserializeBoard(" a , 1 , 2.5 , -3 , 0 , 1 , 1 ;b,2,0,0,1,0,0;| b , a , 0 , 0 ;| b ", data));
+  CHECK(data.components.size() == 2 && data.components[0].id == "a" && data.components[0].x == 2.5f && data.components[0].y == -3.0f);
+  CHECK(data.connections.size() == 1 && data.connections[0].to == "b" && data.connections[0].from == "a");
+  CHECK(data.heads.size() == 1 && data.heads[0] == "b");
+  // Malformed numbers and short records are refused
+  BoardData bad;
+  CHECK(!DeserializeBoard("a,1,x,0,0,1,0;||", bad));
+  CHECK(!DeserializeBoard("a,1,0,0,0;||", bad));
+}
+
+static void TestBinaryIndices() {
+  std::mt19937 rng(8);
+  std::string image = BinaryImage(RandomBoard(rng, 10));
+  BoardView view;
+  CHECK(view.Parse(image.data(), image.size()));
+  // A truncated file or a head pointing past the string table is refused before anything reads it
+  CHECK(!view.Parse(image.data(), image.size() - 1));
+  BinaryHeader header = *view.header;
+  uint32_t head = header.stringCount;
+  size_t offset = sizeof(BinaryHeader) + header.componentCount * sizeof(BinaryComponent) + header.connectionCount * sizeof(BinaryConnection);
+  image.replace(offset, sizeof(head), (const char*)&head, sizeof(head));
+  CHECK(!view.Parse(image.data(), image.size()));
+}
+
+static void TestBinaryPinCounts() {
+  std::mt19937 rng(10);
+  BoardData data = RandomBoard(rng, 10);
+  std::string image = BinaryImage(data);
+  BoardView view;
+  CHECK(view.Parse(image.data(), image.size()));
+  // A gate claiming more pins than its type has would have the loaders write past its pin table
+  BinaryComponent comp;
+  memcpy(&comp, image.data() + sizeof(BinaryHeader), sizeof(comp));
+  comp.inputCount = 9;
+  memcpy(&image[sizeof(BinaryHeader)], &comp, sizeof(comp));
+  CHECK(!view.Parse(image.data(), image.size()));
+}
+
+static void TestBinaryByteOrder() {
+  std::mt19937 rng(9);
+  std::string image = BinaryImage(RandomBoard(rng, 10));
+  BinaryHeader header;
+  memcpy(&header, image.data(), sizeof(header));
+  CHECK(header.byteOrder == BINARY_BYTE_ORDER);
+  // Written on a host of the other byte order
+  header.byteOrder = 0x04030201;
+  memcpy(&image[0], &header, sizeof(header));
+  BoardView view;
+  CHECK(!view.Parse(image.data(), image.size()));
+  // Files from before the marker are little endian
+  header.byteOrder = 0;
+  memcpy(&image[0], &header, sizeof(header));
+  uint32_t one = 1;
+  CHECK(view.Parse(image.data(), image.size()) == (*(const unsigned char*)&one == 1));
+}
+
+static void TestCompressedSizes() {
+  // Tiny blocks that each claim a full block of output
+  std::string frame(COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC));
+  uint32_t version = COMPRESSED_VERSION;
+  frame.append((const char*)&version, sizeof(version));
+  for (int i = 0;i < 1000;i++) {
+    CompressedBlock block = { 1, COMPRESSED_BLOCK_SIZE };
+    frame.append((const char*)&block, sizeof(block));
+    frame.push_back('\0');
+  }
+  CompressedBlock end = { 0, 0 };
+  frame.append((const char*)&end, sizeof(end));
+  std::string buffer;
+  std::string_view bytes;
+  CHECK(!UnpackBoard(frame.data(), frame.size(), buffer, bytes));
+  CHECK(buffer.capacity() < frame.size() * MAX_EXPANSION);
+  // A block larger than the format allows
+  frame.resize(sizeof(CompressedHeader));
+  CompressedBlock large = { 16, COMPRESSED_BLOCK_SIZE + 1 };
+  frame.append((const char*)&large, sizeof(large));
+  frame.append(16, '\0');
+  frame.append((const char*)&end, sizeof(end));
+  CHECK(!UnpackBoard(frame.data(), frame.size(), buffer, bytes));
+}
+
+static void TestDeltaSaves() {
+  std::mt19937 rng(5);
+  for (int binary = 0;binary < 2;binary++) {
+    for (int compress = 0;compress < 2;compress++) {
+      BoardData data = RandomBoard(rng, 50);
+      std::string fileName = binary ? "test_delta.gwb" : "test_delta.txt";
+      CHECK(SaveBoardFile(fileName, data, compress));
+      const std::string& first = data.components[0].id;
+      const std::string& second = data.components[1].id;
+      std::string driver;
+      for (const ComponentRecord& comp : data.components) {
+        if (comp.outputCount > 0 && driver.empty())driver = comp.id;
+      }
+      std::vector<EditOp> edits = {
+        { EDIT_INSERT, "late", "", CODE_AND, 5, 6, 0, 0 },
+        { EDIT_MOVE, second, "", 0, 7, 8, 0, 0 },
+        { EDIT_STATE, first, "", !data.components[0].state, 0, 0, 0, 0 }
+      };
+      // A text board opens the edit section with the first delta, an empty delta leaves the file alone
+      CHECK(AppendDelta(fileName, {}, !binary));
+      CHECK(AppendDelta(fileName, edits, !binary));
+      CHECK(AppendDelta(fileName, { { EDIT_CONNECT, "late", driver, 0, 0, 0, 1, 0 } }, false));
+      CHECK(AppendDelta(fileName, { { EDIT_DELETE, data.components[2].id, "", 0, 0, 0, 0, 0 } }, false));
+      BoardData loaded;
+      CHECK(LoadBoardFile(fileName, loaded));
+      std::map<std::string, ComponentRecord> byId;
+      for (const ComponentRecord& comp : loaded.components)byId[comp.id] = comp;
+      CHECK(loaded.components.size() == data.components.size());
+      CHECK(byId.count("late") && byId["late"].type == CODE_AND && byId["late"].x == 5 && byId["late"].inputCount == 2);
+      CHECK(byId[second].x == 7 && byId[second].y == 8);
+      CHECK(byId[first].state != data.components[0].state);
+      CHECK(byId.count(data.components[2].id) == 0);
+      bool connected = false;
+      for (const ConnectionRecord& conn : loaded.connections)connected = connected || (conn.to == "late" && conn.toPin == 1 && conn.from == driver);
+      CHECK(connected);
+      std::remove(fileName.c_str());
+    }
+  }
+  // Appending needs the snapshot underneath
+  CHECK(!AppendDelta("test_missing.gwb", { { EDIT_DELETE, "x", "", 0, 0, 0, 0, 0 } }, false));
+}
+
+static void TestJournalReplay() {
+  std::mt19937 rng(6);
+  BoardData data = RandomBoard(rng, 40);
+  std::vector<EditOp> edits;
+  for (int i = 0;i < 200;i++) {
+    const ComponentRecord& comp = data.components[rng() % data.components.size()];
+    int kind = rng() % 5;
+    if (kind == 0)edits.push_back({ EDIT_MOVE, comp.id, "", 0, (float)(rng() % 100), 0.5f, 0, 0 });
+    else if (kind == 1)edits.push_back({ EDIT_INSERT, "n" + std::to_string(i), "", CODE_OR, 1, 2, 0, 0 });
+    else if (kind == 2)edits.push_back({ EDIT_CONNECT, comp.id, data.components[rng() % data.components.size()].id, 0, 0, 0, 0, 0 });
+    else if (kind == 3)edits.push_back({ EDIT_DISCONNECT, comp.id, "", 0, 0, 0, 1, 0 });
+    else edits.push_back({ EDIT_STATE, comp.id, "", 1, 0, 0, 0, 0 });
+  }
+  const char* journal = "test_board.journal";
+  std::remove(journal);
+  {
+    BoardSaver saver;
+    saver.AppendJournal(journal, std::vector<EditOp>(edits.begin(), edits.begin() + 120));
+    saver.AppendJournal(journal, std::vector<EditOp>(edits.begin() + 120, edits.end()));
+    saver.Wait();
+  }
+  // A crash in the middle of a record leaves a torn tail, it is dropped
+  std::FILE* file = std::fopen(journal, "ab");
+  std::fputs("M,Gate_2025", file);
+  std::fclose(file);
+  MappedFile mapped;
+  CHECK(mapped.Open(journal));
+  std::vector<EditOp> replayed;
+  ReadEdits(std::string_view(mapped.data, mapped.size), replayed);
+  CHECK(replayed.size() == edits.size());
+  bool same = replayed.size() == edits.size();
+  for (size_t i = 0;same && i < edits.size();i++) {
+    same = replayed[i].kind == edits[i].kind && replayed[i].id == edits[i].id && replayed[i].from == edits[i].from && replayed[i].type == edits[i].type;
+    same = same && replayed[i].x == edits[i].x && replayed[i].y == edits[i].y && replayed[i].pin == edits[i].pin && replayed[i].fromPin == edits[i].fromPin;
+  }
+  CHECK(same);
+  BoardData expected = data, recovered = data;
+  ApplyEdits(expected, edits);
+  ApplyEdits(recovered, replayed);
+  CHECK(Describe(recovered) == Describe(expected));
+  mapped.Close();
+  std::remove(journal);
+}
+
+int main() {
+  TestRoundTrips();
+  TestTextParser();
+  TestBinaryIndices();
+  TestBinaryPinCounts();
+  TestBinaryByteOrder();
+  TestCompressedSizes();
+  TestDeltaSaves();
+  TestJournalReplay();
+  return CheckResult();
+}
@@ -0,0 +1,54 @@
+// SlotMap handles: erased values stop resolving, the values moved by a swap-remove keep resolving
+#include <vector>
+#include "Check.hpp"
+#include "Board/SlotMap.hpp"
+
+static void TestStaleHandle() {
+  SlotMap<int> map;
+  SlotHandle a = map.Insert(1);
+  SlotHandle b = map.Insert(2);
+  CHECK(map.Erase(a));
+  CHECK(!map.Contains(a));
+  CHECK(map.Get(a) == nullptr);
+  CHECK(!map.Erase(a));
+  // The freed slot is reused with a new generation, the old handle still does not resolve
+  SlotHandle c = map.Insert(3);
+  CHECK(c.index == a.index);
+  CHECK(map.Get(a) == nullptr);
+  CHECK(map.Get(c) && *map.Get(c) == 3);
+  CHECK(map.Get(b) && *map.Get(b) == 2);
+  CHECK(map.Size() == 2);
+  // Clear invalidates every handle
+  map.Clear();
+  CHECK(map.Empty());
+  CHECK(map.Get(b) == nullptr);
+  CHECK(map.Get(c) == nullptr);
+  CHECK(map.Get(INVALID_SLOT) == nullptr);
+}
+
+static void TestSwapRemove() {
+  SlotMap<int> map;
+  std::vector<SlotHandle> handles;
+  for (int i = 0;i < 8;i++)handles.push_back(map.Insert(i));
+  // Erasing from the middle moves the last value into the hole
+  CHECK(map.Erase(handles[2]));
+  CHECK(map.values[2] == 7);
+  CHECK(map.Get(handles[7]) == &map.values[2]);
+  for (int i = 0;i < 8;i++) {
+    if (i == 2)continue;
+    CHECK(map.Get(handles[i]) && *map.Get(handles[i]) == i);
+  }
+  // Erasing the last value moves nothing
+  CHECK(map.Erase(handles[6]));
+  CHECK(map.Size() == 6);
+  for (int i = 0;i < 8;i++) {
+    if (i == 2 || i == 6)continue;
+    CHECK(map.Get(handles[i]) && *map.Get(handles[i]) == i);
+  }
+}
+
+int main() {
+  TestStaleHandle();
+  TestSwapRemove();
+  return CheckResult();
+}